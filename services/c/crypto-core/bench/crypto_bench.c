@@ -0,0 +1,149 @@
+/* * Crypto-core microbenchmarks.
+ * Self-contained harness mirroring the threat-engine one: each case is
+ * auto-calibrated and emits one JSON object per line so deploy gating
+ * can diff throughput between builds.
+ *
+ * Build (see BUILD_AND_DEPLOY.md):
+ *   gcc -O2 -Wall -I.. -o crypto-bench crypto_bench.c ../crypto.c \
+ *       -lssl -lcrypto -lpthread
+ *
+ * Covered hot paths: wc_encrypt_aes256gcm and wc_hmac_sha256 across
+ * message sizes — small token-signing payloads up to document chunks,
+ * where per-call setup vs. raw cipher throughput dominate differently.
+ */
+#include "crypto.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+typedef void (*bench_fn)(uint64_t iterations, void *arg);
+
+/* Grows the iteration count until the run crosses min_seconds, then
+   reports the final run. bytes_per_op > 0 adds an MB/s figure. */
+static void run_bench(const char *name, double min_seconds,
+                      size_t bytes_per_op, bench_fn fn, void *arg)
+{
+    uint64_t iterations = 64;
+    double seconds = 0.0;
+
+    for (;;) {
+        double start = bench_now();
+        fn(iterations, arg);
+        seconds = bench_now() - start;
+        if (seconds >= min_seconds || iterations >= (1ull << 32)) break;
+        uint64_t next = (seconds > 0.0)
+            ? (uint64_t)((double)iterations * (min_seconds * 1.4 / seconds))
+            : iterations * 16;
+        if (next > iterations * 16) next = iterations * 16;
+        if (next <= iterations) next = iterations * 2;
+        iterations = next;
+    }
+
+    double ns_per_op = seconds * 1e9 / (double)iterations;
+    if (bytes_per_op > 0) {
+        double mbps = ((double)iterations * (double)bytes_per_op)
+                    / (1024.0 * 1024.0) / seconds;
+        printf("{\"name\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.1f,"
+               "\"ops_per_sec\":%.0f,\"mb_per_sec\":%.1f}\n",
+               name, (unsigned long long)iterations, ns_per_op,
+               (double)iterations / seconds, mbps);
+    } else {
+        printf("{\"name\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.1f,"
+               "\"ops_per_sec\":%.0f}\n",
+               name, (unsigned long long)iterations, ns_per_op,
+               (double)iterations / seconds);
+    }
+    fflush(stdout);
+}
+
+typedef struct {
+    WorkChainCryptoContext *ctx;
+    unsigned char *plaintext;
+    unsigned char *ciphertext;
+    size_t msg_len;
+} encrypt_case;
+
+static void bench_encrypt(uint64_t iterations, void *arg)
+{
+    encrypt_case *c = (encrypt_case*)arg;
+    unsigned char tag[16];
+    size_t ct_len;
+    for (uint64_t i = 0; i < iterations; i++) {
+        wc_encrypt_aes256gcm(c->ctx, c->plaintext, c->msg_len,
+                             (const unsigned char*)"bench-org", 9,
+                             c->ciphertext, &ct_len, tag, 16);
+    }
+}
+
+typedef struct {
+    unsigned char key[32];
+    unsigned char *msg;
+    size_t msg_len;
+} hmac_case;
+
+static void bench_hmac(uint64_t iterations, void *arg)
+{
+    hmac_case *c = (hmac_case*)arg;
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    for (uint64_t i = 0; i < iterations; i++) {
+        size_t digest_len = sizeof(digest); /* capacity in, length out */
+        wc_hmac_sha256(c->key, 32, c->msg, c->msg_len, digest, &digest_len);
+    }
+}
+
+int main(void)
+{
+    static const size_t encrypt_sizes[] = { 64, 4096, 1024 * 1024 };
+    static const size_t hmac_sizes[]    = { 64, 1024, 16384 };
+    char name[64];
+
+    unsigned char key[32];
+    for (int i = 0; i < 32; i++) key[i] = (unsigned char)i;
+    WorkChainCryptoContext *ctx = wc_crypto_init(key, 32);
+    if (!ctx) {
+        fprintf(stderr, "wc_crypto_init failed\n");
+        return 1;
+    }
+
+    for (size_t s = 0; s < sizeof(encrypt_sizes) / sizeof(encrypt_sizes[0]); s++) {
+        encrypt_case c;
+        c.ctx = ctx;
+        c.msg_len = encrypt_sizes[s];
+        c.plaintext = malloc(c.msg_len);
+        c.ciphertext = malloc(c.msg_len + 12 + 16);
+        if (!c.plaintext || !c.ciphertext) return 1;
+        memset(c.plaintext, 0xA5, c.msg_len);
+
+        snprintf(name, sizeof(name), "wc_encrypt_aes256gcm/bytes:%zu", c.msg_len);
+        run_bench(name, 0.5, c.msg_len, bench_encrypt, &c);
+
+        free(c.plaintext);
+        free(c.ciphertext);
+    }
+
+    for (size_t s = 0; s < sizeof(hmac_sizes) / sizeof(hmac_sizes[0]); s++) {
+        hmac_case c;
+        memcpy(c.key, key, 32);
+        c.msg_len = hmac_sizes[s];
+        c.msg = malloc(c.msg_len);
+        if (!c.msg) return 1;
+        memset(c.msg, 0x5A, c.msg_len);
+
+        snprintf(name, sizeof(name), "wc_hmac_sha256/bytes:%zu", c.msg_len);
+        run_bench(name, 0.5, c.msg_len, bench_hmac, &c);
+
+        free(c.msg);
+    }
+
+    wc_crypto_free(ctx);
+    return 0;
+}
@@ -1,10 +1,18 @@
 #include "crypto.h"
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <pthread.h>
+#include <time.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include <openssl/err.h>
 #include <openssl/rand.h>
 #include <openssl/evp.h>
 #include <openssl/hmac.h>
+#include <openssl/params.h>
+#include <openssl/core_names.h>
 
 /* * CRITICAL CONFIGURATION:
  * Ensure your header file defines WCCryptoError constants properly.
@@ -29,6 +37,11 @@ WorkChainCryptoContext* wc_crypto_init(const unsigned char *master_key, size_t k
     ctx->hash_ctx = NULL;
 
     memcpy(ctx->key, master_key, 32);
+
+    /* Random-IV mode until deterministic construction is enabled */
+    memset(ctx->iv_prefix, 0, sizeof(ctx->iv_prefix));
+    ctx->iv_counter = 0;
+    ctx->deterministic_iv = 0;
     
     /* Generate secure random salt for key derivation if needed later */
     if (RAND_bytes(ctx->salt, 16) != 1) {
@@ -55,6 +68,107 @@ void wc_crypto_free(WorkChainCryptoContext *ctx)
     free(ctx);
 }
 
+/* * Size-classed slab pool behind the SecureBuffer API.
+ * The dominant allocation pattern is millions of short-lived 32-256 byte
+ * secrets (tokens, tags, derived keys); paying two heap allocations on
+ * alloc and a full-capacity cleanse on free per secret shows up as
+ * malloc churn in crypto flamegraphs. Small requests are now served from
+ * mlock'd slabs carved into fixed-size nodes (header + SecureBuffer +
+ * payload in one piece), recycled through a per-thread free list with a
+ * mutex-protected global list as spill/refill — the common alloc/free
+ * pair is a pointer pop/push with no locking. Freeing cleanses only the
+ * bytes the caller actually wrote (buf->size), not the whole class.
+ * Requests above the largest class keep the original heap path and its
+ * full-capacity wipe. Slabs live for the process lifetime.
+ */
+#define WC_SLAB_CLASSES      4
+#define WC_SLAB_BYTES        (64 * 1024)
+#define WC_SLAB_THREAD_MAX   64      /* nodes cached per thread per class */
+#define WC_SLAB_CLASS_HEAP   0xFFFFFFFFu
+
+static const size_t wc_slab_class_size[WC_SLAB_CLASSES] = { 32, 64, 128, 256 };
+
+typedef struct WCSecureNode {
+    uint32_t size_class;             /* index, or WC_SLAB_CLASS_HEAP */
+    struct WCSecureNode *next;       /* free-list link; unused while live */
+    SecureBuffer buf;
+    unsigned char payload[];         /* class-sized, inside the mlock'd slab */
+} WCSecureNode;
+
+typedef struct {
+    WCSecureNode *free_list[WC_SLAB_CLASSES];
+    unsigned count[WC_SLAB_CLASSES];
+} WCSecureThreadCache;
+
+static pthread_mutex_t wc_slab_lock = PTHREAD_MUTEX_INITIALIZER;
+static WCSecureNode *wc_slab_global_free[WC_SLAB_CLASSES];
+static pthread_key_t wc_slab_tls_key;
+static pthread_once_t wc_slab_tls_once = PTHREAD_ONCE_INIT;
+
+/* Exiting threads hand their cached nodes back to the global lists */
+static void wc_slab_tls_destroy(void *ptr)
+{
+    WCSecureThreadCache *cache = (WCSecureThreadCache*)ptr;
+    if (!cache) return;
+
+    pthread_mutex_lock(&wc_slab_lock);
+    for (int c = 0; c < WC_SLAB_CLASSES; c++) {
+        while (cache->free_list[c]) {
+            WCSecureNode *node = cache->free_list[c];
+            cache->free_list[c] = node->next;
+            node->next = wc_slab_global_free[c];
+            wc_slab_global_free[c] = node;
+        }
+    }
+    pthread_mutex_unlock(&wc_slab_lock);
+    free(cache);
+}
+
+static void wc_slab_tls_init_key(void)
+{
+    pthread_key_create(&wc_slab_tls_key, wc_slab_tls_destroy);
+}
+
+static WCSecureThreadCache* wc_slab_thread_cache(void)
+{
+    pthread_once(&wc_slab_tls_once, wc_slab_tls_init_key);
+
+    WCSecureThreadCache *cache =
+        (WCSecureThreadCache*)pthread_getspecific(wc_slab_tls_key);
+    if (!cache) {
+        cache = (WCSecureThreadCache*)calloc(1, sizeof(WCSecureThreadCache));
+        if (cache) pthread_setspecific(wc_slab_tls_key, cache);
+    }
+    return cache;
+}
+
+/* Caller holds wc_slab_lock. Maps and locks one slab, carves it into
+   nodes of the given class and prepends them to the global free list. */
+static int wc_slab_grow(int size_class)
+{
+    void *slab = mmap(NULL, WC_SLAB_BYTES, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (slab == MAP_FAILED) return 0;
+
+    /* Best effort: without CAP_IPC_LOCK / raised RLIMIT_MEMLOCK the pool
+       still works, just without the swap-out guarantee */
+    (void)mlock(slab, WC_SLAB_BYTES);
+
+    size_t node_bytes = sizeof(WCSecureNode) + wc_slab_class_size[size_class];
+    node_bytes = (node_bytes + 15) & ~(size_t)15;
+
+    unsigned char *cursor = (unsigned char*)slab;
+    unsigned char *slab_end = cursor + WC_SLAB_BYTES;
+    while (cursor + node_bytes <= slab_end) {
+        WCSecureNode *node = (WCSecureNode*)cursor;
+        node->size_class = (uint32_t)size_class;
+        node->next = wc_slab_global_free[size_class];
+        wc_slab_global_free[size_class] = node;
+        cursor += node_bytes;
+    }
+    return 1;
+}
+
 /* Allocate secure buffer */
 SecureBuffer* wc_secure_buffer_alloc(size_t size)
 {
@@ -62,19 +176,50 @@ SecureBuffer* wc_secure_buffer_alloc(size_t size)
         return NULL;
     }
 
-    SecureBuffer *buf = (SecureBuffer*)malloc(sizeof(SecureBuffer));
-    if (!buf) return NULL;
+    /* Small secrets: pop from the slab pool */
+    for (int c = 0; c < WC_SLAB_CLASSES; c++) {
+        if (size > wc_slab_class_size[c]) continue;
+
+        WCSecureNode *node = NULL;
+        WCSecureThreadCache *cache = wc_slab_thread_cache();
+        if (cache && cache->free_list[c]) {
+            node = cache->free_list[c];
+            cache->free_list[c] = node->next;
+            cache->count[c]--;
+        } else {
+            pthread_mutex_lock(&wc_slab_lock);
+            if (!wc_slab_global_free[c] && !wc_slab_grow(c)) {
+                pthread_mutex_unlock(&wc_slab_lock);
+                break; /* slab exhausted and cannot grow: fall to heap */
+            }
+            node = wc_slab_global_free[c];
+            wc_slab_global_free[c] = node->next;
+            pthread_mutex_unlock(&wc_slab_lock);
+        }
 
-    buf->data = (unsigned char*)OPENSSL_malloc(size);
-    if (!buf->data) {
-        free(buf);
+        node->next = NULL;
+        node->buf.data = node->payload;
+        node->buf.size = 0;
+        node->buf.allocated = wc_slab_class_size[c];
+        return &node->buf;
+    }
+
+    /* Large buffers keep the original heap path */
+    WCSecureNode *node = (WCSecureNode*)malloc(sizeof(WCSecureNode));
+    if (!node) return NULL;
+
+    node->size_class = WC_SLAB_CLASS_HEAP;
+    node->next = NULL;
+    node->buf.data = (unsigned char*)OPENSSL_malloc(size);
+    if (!node->buf.data) {
+        free(node);
         return NULL;
     }
 
-    buf->size = 0;
-    buf->allocated = size;
+    node->buf.size = 0;
+    node->buf.allocated = size;
 
-    return buf;
+    return &node->buf;
 }
 
 /* Free secure buffer */
@@ -82,12 +227,36 @@ void wc_secure_buffer_free(SecureBuffer *buf)
 {
     if (!buf) return;
 
-    if (buf->data) {
-        OPENSSL_cleanse(buf->data, buf->allocated);
-        OPENSSL_free(buf->data);
+    WCSecureNode *node =
+        (WCSecureNode*)((unsigned char*)buf - offsetof(WCSecureNode, buf));
+
+    if (node->size_class == WC_SLAB_CLASS_HEAP) {
+        if (buf->data) {
+            OPENSSL_cleanse(buf->data, buf->allocated);
+            OPENSSL_free(buf->data);
+        }
+        free(node);
+        return;
     }
 
-    free(buf);
+    /* Wipe only what was written; the rest of the block never held a secret */
+    if (buf->data && buf->size > 0) {
+        OPENSSL_cleanse(buf->data, buf->size);
+    }
+    buf->size = 0;
+
+    int c = (int)node->size_class;
+    WCSecureThreadCache *cache = wc_slab_thread_cache();
+    if (cache && cache->count[c] < WC_SLAB_THREAD_MAX) {
+        node->next = cache->free_list[c];
+        cache->free_list[c] = node;
+        cache->count[c]++;
+    } else {
+        pthread_mutex_lock(&wc_slab_lock);
+        node->next = wc_slab_global_free[c];
+        wc_slab_global_free[c] = node;
+        pthread_mutex_unlock(&wc_slab_lock);
+    }
 }
 
 /* Secure wipe buffer */
@@ -103,6 +272,184 @@ WCCryptoError wc_secure_buffer_wipe(SecureBuffer *buf)
     return WC_CRYPTO_SUCCESS;
 }
 
+/* * Per-thread entropy buffer.
+ * RAND_bytes takes a process-global lock and runs the DRBG mixing on
+ * every call; at small-message encrypt rates that shows up as real
+ * time and serializes worker threads. Each thread instead refills a
+ * 4 KiB block once per ~340 IVs and serves small requests from it with
+ * plain copies. The buffer is cleansed on thread exit like the cipher
+ * cache.
+ */
+#define WC_ENTROPY_BUFFER_BYTES 4096
+
+typedef struct {
+    unsigned char buf[WC_ENTROPY_BUFFER_BYTES];
+    size_t off;                /* next unserved byte; == size means empty */
+} WCThreadEntropy;
+
+static pthread_key_t wc_entropy_key;
+static pthread_once_t wc_entropy_once = PTHREAD_ONCE_INIT;
+
+static void wc_entropy_destroy(void *ptr)
+{
+    if (!ptr) return;
+    OPENSSL_cleanse(ptr, sizeof(WCThreadEntropy));
+    free(ptr);
+}
+
+static void wc_entropy_init_key(void)
+{
+    pthread_key_create(&wc_entropy_key, wc_entropy_destroy);
+}
+
+static WCCryptoError wc_thread_random(unsigned char *buf, size_t buf_len)
+{
+    /* Large requests bypass the buffer: the copy would not amortize */
+    if (buf_len > WC_ENTROPY_BUFFER_BYTES / 4) {
+        return (RAND_bytes(buf, buf_len) == 1) ? WC_CRYPTO_SUCCESS : WC_CRYPTO_FAILURE;
+    }
+
+    pthread_once(&wc_entropy_once, wc_entropy_init_key);
+
+    WCThreadEntropy *pool = (WCThreadEntropy*)pthread_getspecific(wc_entropy_key);
+    if (!pool) {
+        pool = (WCThreadEntropy*)malloc(sizeof(WCThreadEntropy));
+        if (!pool) {
+            return (RAND_bytes(buf, buf_len) == 1) ? WC_CRYPTO_SUCCESS : WC_CRYPTO_FAILURE;
+        }
+        pool->off = WC_ENTROPY_BUFFER_BYTES;
+        pthread_setspecific(wc_entropy_key, pool);
+    }
+
+    if (pool->off + buf_len > WC_ENTROPY_BUFFER_BYTES) {
+        if (RAND_bytes(pool->buf, WC_ENTROPY_BUFFER_BYTES) != 1) {
+            return WC_CRYPTO_FAILURE;
+        }
+        pool->off = 0;
+    }
+
+    memcpy(buf, pool->buf + pool->off, buf_len);
+    /* Never serve the same bytes twice */
+    OPENSSL_cleanse(pool->buf + pool->off, buf_len);
+    pool->off += buf_len;
+
+    return WC_CRYPTO_SUCCESS;
+}
+
+/* Produces the next 96-bit IV for an encrypt call on this context:
+   SP 800-38D deterministic construction (fixed field || big-endian
+   invocation counter) when enabled, per-thread buffered randomness
+   otherwise. */
+static WCCryptoError wc_next_iv(WorkChainCryptoContext *ctx, unsigned char iv[12])
+{
+    if (ctx->deterministic_iv) {
+        uint64_t n = __atomic_fetch_add(&ctx->iv_counter, 1, __ATOMIC_RELAXED);
+        memcpy(iv, ctx->iv_prefix, 4);
+        for (int i = 0; i < 8; i++) {
+            iv[4 + i] = (unsigned char)(n >> (56 - 8 * i));
+        }
+        return WC_CRYPTO_SUCCESS;
+    }
+    return wc_thread_random(iv, 12);
+}
+
+WCCryptoError wc_crypto_enable_deterministic_iv(WorkChainCryptoContext *ctx)
+{
+    if (!ctx) return WC_CRYPTO_INVALID_INPUT;
+
+    if (RAND_bytes(ctx->iv_prefix, sizeof(ctx->iv_prefix)) != 1) {
+        return WC_CRYPTO_FAILURE;
+    }
+    __atomic_store_n(&ctx->iv_counter, 0, __ATOMIC_RELAXED);
+    ctx->deterministic_iv = 1;
+
+    return WC_CRYPTO_SUCCESS;
+}
+
+/* * Per-thread cipher context pool.
+ * EVP_CIPHER_CTX_new + full EVP_EncryptInit_ex per call means a fresh
+ * allocation and a full AES key schedule expansion for every message —
+ * for the token-signing path (~5k small encryptions/sec/worker) setup
+ * dominated the actual crypto. Each thread keeps one keyed encrypt and
+ * one keyed decrypt context; as long as the caller's key is unchanged we
+ * re-init with only the IV (EVP re-keys the schedule only when a key is
+ * supplied), so the hot path skips both the allocation and the key
+ * expansion. The cache is confined to its thread, so no locking.
+ */
+typedef struct {
+    EVP_CIPHER_CTX *evp;
+    unsigned char key[32];
+    int keyed;
+} WCThreadCipherSlot;
+
+typedef struct {
+    WCThreadCipherSlot enc;
+    WCThreadCipherSlot dec;
+} WCThreadCipherCache;
+
+static pthread_key_t wc_cipher_cache_key;
+static pthread_once_t wc_cipher_cache_once = PTHREAD_ONCE_INIT;
+
+static void wc_cipher_cache_destroy(void *ptr)
+{
+    WCThreadCipherCache *cache = (WCThreadCipherCache*)ptr;
+    if (!cache) return;
+    if (cache->enc.evp) EVP_CIPHER_CTX_free(cache->enc.evp);
+    if (cache->dec.evp) EVP_CIPHER_CTX_free(cache->dec.evp);
+    OPENSSL_cleanse(cache, sizeof(*cache));
+    free(cache);
+}
+
+static void wc_cipher_cache_init_key(void)
+{
+    pthread_key_create(&wc_cipher_cache_key, wc_cipher_cache_destroy);
+}
+
+/* Returns a GCM context keyed for ctx->key with the given IV applied,
+   or NULL on failure. The returned context is owned by the thread cache:
+   callers must NOT free it. */
+static EVP_CIPHER_CTX* wc_thread_cipher(
+    const WorkChainCryptoContext *ctx,
+    int encrypting,
+    const unsigned char *iv)
+{
+    pthread_once(&wc_cipher_cache_once, wc_cipher_cache_init_key);
+
+    WCThreadCipherCache *cache = (WCThreadCipherCache*)pthread_getspecific(wc_cipher_cache_key);
+    if (!cache) {
+        cache = (WCThreadCipherCache*)calloc(1, sizeof(WCThreadCipherCache));
+        if (!cache) return NULL;
+        pthread_setspecific(wc_cipher_cache_key, cache);
+    }
+
+    WCThreadCipherSlot *slot = encrypting ? &cache->enc : &cache->dec;
+
+    if (!slot->evp) {
+        slot->evp = EVP_CIPHER_CTX_new();
+        if (!slot->evp) return NULL;
+    }
+
+    int ok;
+    if (slot->keyed && CRYPTO_memcmp(slot->key, ctx->key, 32) == 0) {
+        /* Same key as last time: IV rotation only, no key schedule */
+        ok = encrypting
+            ? EVP_EncryptInit_ex(slot->evp, NULL, NULL, NULL, iv)
+            : EVP_DecryptInit_ex(slot->evp, NULL, NULL, NULL, iv);
+    } else {
+        ok = encrypting
+            ? EVP_EncryptInit_ex(slot->evp, EVP_aes_256_gcm(), NULL, ctx->key, iv)
+            : EVP_DecryptInit_ex(slot->evp, EVP_aes_256_gcm(), NULL, ctx->key, iv);
+        if (ok == 1) {
+            memcpy(slot->key, ctx->key, 32);
+            slot->keyed = 1;
+        } else {
+            slot->keyed = 0;
+        }
+    }
+
+    return (ok == 1) ? slot->evp : NULL;
+}
+
 /* * AES-256-GCM Encryption WITH ORGANIZATION BINDING (AAD)
  * * aad: Additional Authenticated Data (Pass the Organization UUID here!)
  * aad_len: Length of the Org ID
@@ -126,37 +473,31 @@ WCCryptoError wc_encrypt_aes256gcm(
         return WC_CRYPTO_OVERFLOW;
     }
 
-    EVP_CIPHER_CTX *cipher_ctx = EVP_CIPHER_CTX_new();
-    if (!cipher_ctx) return WC_CRYPTO_MEMORY_ERROR;
-
     int len;
     unsigned char iv[12]; /* 96-bit IV standard for GCM */
 
-    /* Generate a FRESH IV for every encryption. Critical for GCM Security. */
-    if (RAND_bytes(iv, 12) != 1) {
-        EVP_CIPHER_CTX_free(cipher_ctx);
+    /* FRESH IV for every encryption (random or counter-constructed).
+       Critical for GCM Security. */
+    if (wc_next_iv(ctx, iv) != WC_CRYPTO_SUCCESS) {
         return WC_CRYPTO_FAILURE;
     }
 
-    /* Initialize encryption */
-    if (1 != EVP_EncryptInit_ex(cipher_ctx, EVP_aes_256_gcm(), NULL, ctx->key, iv)) {
-        EVP_CIPHER_CTX_free(cipher_ctx);
-        return WC_CRYPTO_FAILURE;
-    }
+    /* Initialize encryption on the pooled per-thread context: only the
+       IV changes when the key matches the last call */
+    EVP_CIPHER_CTX *cipher_ctx = wc_thread_cipher(ctx, 1, iv);
+    if (!cipher_ctx) return WC_CRYPTO_MEMORY_ERROR;
 
     /* * CRITICAL FIX: Add AAD (Organization ID binding).
      * This ensures the ciphertext is mathematically invalid if used in the wrong Org context.
      */
     if (aad && aad_len > 0) {
         if (1 != EVP_EncryptUpdate(cipher_ctx, NULL, &len, aad, aad_len)) {
-            EVP_CIPHER_CTX_free(cipher_ctx);
             return WC_CRYPTO_FAILURE;
         }
     }
 
     /* Encrypt body */
     if (1 != EVP_EncryptUpdate(cipher_ctx, ciphertext + 12, &len, plaintext, plaintext_len)) {
-        EVP_CIPHER_CTX_free(cipher_ctx);
         return WC_CRYPTO_FAILURE;
     }
 
@@ -164,14 +505,12 @@ WCCryptoError wc_encrypt_aes256gcm(
 
     /* Finalize */
     if (1 != EVP_EncryptFinal_ex(cipher_ctx, ciphertext + 12 + len, &len)) {
-        EVP_CIPHER_CTX_free(cipher_ctx);
         return WC_CRYPTO_FAILURE;
     }
     ciphertext_body_len += len;
 
     /* Get authentication tag */
     if (1 != EVP_CIPHER_CTX_ctrl(cipher_ctx, EVP_CTRL_GCM_GET_TAG, tag_len, tag)) {
-        EVP_CIPHER_CTX_free(cipher_ctx);
         return WC_CRYPTO_FAILURE;
     }
 
@@ -181,8 +520,6 @@ WCCryptoError wc_encrypt_aes256gcm(
     
     *ciphertext_len = ciphertext_body_len + 12;
 
-    EVP_CIPHER_CTX_free(cipher_ctx);
-
     return WC_CRYPTO_SUCCESS;
 }
 
@@ -203,9 +540,6 @@ WCCryptoError wc_decrypt_aes256gcm(
         return WC_CRYPTO_INVALID_INPUT;
     }
 
-    EVP_CIPHER_CTX *cipher_ctx = EVP_CIPHER_CTX_new();
-    if (!cipher_ctx) return WC_CRYPTO_MEMORY_ERROR;
-
     /* Extract IV from the first 12 bytes */
     const unsigned char *iv = ciphertext;
     const unsigned char *actual_ciphertext = ciphertext + 12;
@@ -213,24 +547,20 @@ WCCryptoError wc_decrypt_aes256gcm(
 
     int len;
 
-    if (1 != EVP_DecryptInit_ex(cipher_ctx, EVP_aes_256_gcm(), NULL, ctx->key, iv)) {
-        EVP_CIPHER_CTX_free(cipher_ctx);
-        return WC_CRYPTO_FAILURE;
-    }
+    EVP_CIPHER_CTX *cipher_ctx = wc_thread_cipher(ctx, 0, iv);
+    if (!cipher_ctx) return WC_CRYPTO_MEMORY_ERROR;
 
     /* * CRITICAL FIX: Feed AAD (Organization ID) to the decryptor.
      * If this doesn't match what was used during encryption, DecryptFinal will fail.
      */
     if (aad && aad_len > 0) {
         if (1 != EVP_DecryptUpdate(cipher_ctx, NULL, &len, aad, aad_len)) {
-            EVP_CIPHER_CTX_free(cipher_ctx);
             return WC_CRYPTO_FAILURE;
         }
     }
 
     /* Decrypt body */
     if (1 != EVP_DecryptUpdate(cipher_ctx, plaintext, &len, actual_ciphertext, actual_ciphertext_len)) {
-        EVP_CIPHER_CTX_free(cipher_ctx);
         return WC_CRYPTO_FAILURE;
     }
 
@@ -238,7 +568,6 @@ WCCryptoError wc_decrypt_aes256gcm(
 
     /* Set expected tag */
     if (1 != EVP_CIPHER_CTX_ctrl(cipher_ctx, EVP_CTRL_GCM_SET_TAG, (int)tag_len, (void*)tag)) {
-        EVP_CIPHER_CTX_free(cipher_ctx);
         return WC_CRYPTO_FAILURE;
     }
 
@@ -249,18 +578,328 @@ WCCryptoError wc_decrypt_aes256gcm(
     if (EVP_DecryptFinal_ex(cipher_ctx, plaintext + len, &len) <= 0) {
         /* WIPE plaintext buffer to be safe */
         OPENSSL_cleanse(plaintext, plaintext_len_tmp); 
-        EVP_CIPHER_CTX_free(cipher_ctx);
         return WC_CRYPTO_AUTH_FAILED; /* Define this in your header */
     }
 
     plaintext_len_tmp += len;
     *plaintext_len = plaintext_len_tmp;
 
-    EVP_CIPHER_CTX_free(cipher_ctx);
+    return WC_CRYPTO_SUCCESS;
+}
+
+/* Summed length of a region list; WC_CRYPTO_INVALID_INPUT conditions
+   (NULL base with nonzero len, overflow) collapse to (size_t)-1 */
+static size_t wc_iov_total(const struct iovec *iov, int iovcnt)
+{
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (!iov[i].iov_base && iov[i].iov_len > 0) return (size_t)-1;
+        if (iov[i].iov_len > (size_t)-1 - total) return (size_t)-1;
+        total += iov[i].iov_len;
+    }
+    return total;
+}
+
+/* * Scatter-gather AES-256-GCM: region lists straight into the cipher.
+ * Same framing and AAD semantics as the one-shot calls; the per-thread
+ * cipher pool is shared with them.
+ */
+WCCryptoError wc_encrypt_aes256gcm_iov(
+    WorkChainCryptoContext *ctx,
+    const struct iovec *in,
+    int iovcnt,
+    const struct iovec *aad,
+    int aadcnt,
+    unsigned char *ciphertext,
+    size_t *ciphertext_len,
+    unsigned char *tag,
+    size_t tag_len)
+{
+    if (!ctx || !in || iovcnt <= 0 || !ciphertext || !ciphertext_len ||
+        !tag || tag_len < 16 || (aadcnt > 0 && !aad) || aadcnt < 0) {
+        return WC_CRYPTO_INVALID_INPUT;
+    }
+
+    size_t total = wc_iov_total(in, iovcnt);
+    if (total == (size_t)-1) return WC_CRYPTO_INVALID_INPUT;
+    if (total > (1024 * 1024 * 50)) return WC_CRYPTO_OVERFLOW;
+
+    int len;
+    unsigned char iv[12];
+
+    if (wc_next_iv(ctx, iv) != WC_CRYPTO_SUCCESS) {
+        return WC_CRYPTO_FAILURE;
+    }
+
+    EVP_CIPHER_CTX *cipher_ctx = wc_thread_cipher(ctx, 1, iv);
+    if (!cipher_ctx) return WC_CRYPTO_MEMORY_ERROR;
+
+    /* AAD regions (Org ID binding), fed in order without concatenation */
+    for (int i = 0; i < aadcnt; i++) {
+        if (aad[i].iov_len == 0) continue;
+        if (1 != EVP_EncryptUpdate(cipher_ctx, NULL, &len,
+                                   (const unsigned char*)aad[i].iov_base,
+                                   aad[i].iov_len)) {
+            return WC_CRYPTO_FAILURE;
+        }
+    }
+
+    /* Body regions encrypt directly to their slot in the output */
+    size_t written = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (in[i].iov_len == 0) continue;
+        if (1 != EVP_EncryptUpdate(cipher_ctx, ciphertext + 12 + written, &len,
+                                   (const unsigned char*)in[i].iov_base,
+                                   in[i].iov_len)) {
+            return WC_CRYPTO_FAILURE;
+        }
+        written += (size_t)len;
+    }
+
+    if (1 != EVP_EncryptFinal_ex(cipher_ctx, ciphertext + 12 + written, &len)) {
+        return WC_CRYPTO_FAILURE;
+    }
+    written += (size_t)len;
+
+    if (1 != EVP_CIPHER_CTX_ctrl(cipher_ctx, EVP_CTRL_GCM_GET_TAG, tag_len, tag)) {
+        return WC_CRYPTO_FAILURE;
+    }
+
+    memcpy(ciphertext, iv, 12);
+    *ciphertext_len = written + 12;
 
     return WC_CRYPTO_SUCCESS;
 }
 
+WCCryptoError wc_decrypt_aes256gcm_iov(
+    WorkChainCryptoContext *ctx,
+    const struct iovec *in,
+    int iovcnt,
+    const struct iovec *aad,
+    int aadcnt,
+    unsigned char *plaintext,
+    size_t *plaintext_len,
+    const unsigned char *tag,
+    size_t tag_len)
+{
+    if (!ctx || !in || iovcnt <= 0 || !plaintext || !plaintext_len ||
+        !tag || tag_len < 16 || (aadcnt > 0 && !aad) || aadcnt < 0) {
+        return WC_CRYPTO_INVALID_INPUT;
+    }
+
+    size_t total = wc_iov_total(in, iovcnt);
+    if (total == (size_t)-1 || total < 12) return WC_CRYPTO_INVALID_INPUT;
+
+    /* Gather the IV from the head of the chain, wherever the region
+       boundaries fall */
+    unsigned char iv[12];
+    size_t iv_have = 0;
+    int body_start = 0;
+    size_t body_skip = 0;
+    for (int i = 0; i < iovcnt && iv_have < 12; i++) {
+        size_t take = 12 - iv_have;
+        if (take > in[i].iov_len) take = in[i].iov_len;
+        memcpy(iv + iv_have, in[i].iov_base, take);
+        iv_have += take;
+        body_start = i;
+        body_skip = take;
+    }
+
+    int len;
+
+    EVP_CIPHER_CTX *cipher_ctx = wc_thread_cipher(ctx, 0, iv);
+    if (!cipher_ctx) return WC_CRYPTO_MEMORY_ERROR;
+
+    for (int i = 0; i < aadcnt; i++) {
+        if (aad[i].iov_len == 0) continue;
+        if (1 != EVP_DecryptUpdate(cipher_ctx, NULL, &len,
+                                   (const unsigned char*)aad[i].iov_base,
+                                   aad[i].iov_len)) {
+            return WC_CRYPTO_FAILURE;
+        }
+    }
+
+    size_t written = 0;
+    for (int i = body_start; i < iovcnt; i++) {
+        const unsigned char *base = (const unsigned char*)in[i].iov_base;
+        size_t region_len = in[i].iov_len;
+        if (i == body_start) {
+            base += body_skip;
+            region_len -= body_skip;
+        }
+        if (region_len == 0) continue;
+        if (1 != EVP_DecryptUpdate(cipher_ctx, plaintext + written, &len,
+                                   base, region_len)) {
+            return WC_CRYPTO_FAILURE;
+        }
+        written += (size_t)len;
+    }
+
+    if (1 != EVP_CIPHER_CTX_ctrl(cipher_ctx, EVP_CTRL_GCM_SET_TAG, (int)tag_len, (void*)tag)) {
+        return WC_CRYPTO_FAILURE;
+    }
+
+    if (EVP_DecryptFinal_ex(cipher_ctx, plaintext + written, &len) <= 0) {
+        OPENSSL_cleanse(plaintext, written);
+        return WC_CRYPTO_AUTH_FAILED;
+    }
+    written += (size_t)len;
+
+    *plaintext_len = written;
+
+    return WC_CRYPTO_SUCCESS;
+}
+
+/* * Streaming AES-256-GCM
+ * Constant-memory chunked encryption for large document bundles.
+ */
+struct WorkChainCryptoStream {
+    EVP_CIPHER_CTX *evp;
+    int encrypting; /* 1 = encrypt stream, 0 = decrypt stream */
+};
+
+static WorkChainCryptoStream* wc_stream_new(
+    WorkChainCryptoContext *ctx,
+    const unsigned char *aad,
+    size_t aad_len,
+    const unsigned char *iv,
+    int encrypting)
+{
+    if (!ctx || !iv) return NULL;
+
+    WorkChainCryptoStream *stream = (WorkChainCryptoStream*)malloc(sizeof(WorkChainCryptoStream));
+    if (!stream) return NULL;
+
+    stream->evp = EVP_CIPHER_CTX_new();
+    stream->encrypting = encrypting;
+    if (!stream->evp) {
+        free(stream);
+        return NULL;
+    }
+
+    int ok = encrypting
+        ? EVP_EncryptInit_ex(stream->evp, EVP_aes_256_gcm(), NULL, ctx->key, iv)
+        : EVP_DecryptInit_ex(stream->evp, EVP_aes_256_gcm(), NULL, ctx->key, iv);
+
+    if (ok == 1 && aad && aad_len > 0) {
+        int len;
+        ok = encrypting
+            ? EVP_EncryptUpdate(stream->evp, NULL, &len, aad, aad_len)
+            : EVP_DecryptUpdate(stream->evp, NULL, &len, aad, aad_len);
+    }
+
+    if (ok != 1) {
+        EVP_CIPHER_CTX_free(stream->evp);
+        free(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+WorkChainCryptoStream* wc_encrypt_stream_init(
+    WorkChainCryptoContext *ctx,
+    const unsigned char *aad,
+    size_t aad_len,
+    unsigned char *iv_out)
+{
+    if (!ctx || !iv_out) return NULL;
+
+    /* Fresh IV per stream, exactly like the one-shot path */
+    if (wc_next_iv(ctx, iv_out) != WC_CRYPTO_SUCCESS) {
+        return NULL;
+    }
+    return wc_stream_new(ctx, aad, aad_len, iv_out, 1);
+}
+
+WorkChainCryptoStream* wc_decrypt_stream_init(
+    WorkChainCryptoContext *ctx,
+    const unsigned char *aad,
+    size_t aad_len,
+    const unsigned char *iv)
+{
+    return wc_stream_new(ctx, aad, aad_len, iv, 0);
+}
+
+WCCryptoError wc_crypto_stream_update(
+    WorkChainCryptoStream *stream,
+    const unsigned char *in,
+    size_t in_len,
+    unsigned char *out,
+    size_t *out_len)
+{
+    if (!stream || !in || !out || !out_len) {
+        return WC_CRYPTO_INVALID_INPUT;
+    }
+    if (in_len > INT_MAX) {
+        return WC_CRYPTO_OVERFLOW; /* feed EVP in sub-2GB chunks */
+    }
+
+    int len = 0;
+    int ok = stream->encrypting
+        ? EVP_EncryptUpdate(stream->evp, out, &len, in, in_len)
+        : EVP_DecryptUpdate(stream->evp, out, &len, in, in_len);
+
+    if (ok != 1) {
+        return WC_CRYPTO_FAILURE;
+    }
+    *out_len = (size_t)len;
+    return WC_CRYPTO_SUCCESS;
+}
+
+WCCryptoError wc_encrypt_stream_final(
+    WorkChainCryptoStream *stream,
+    unsigned char *tag,
+    size_t tag_len)
+{
+    if (!stream || !tag || tag_len < 16 || !stream->encrypting) {
+        if (stream) wc_crypto_stream_abort(stream);
+        return WC_CRYPTO_INVALID_INPUT;
+    }
+
+    WCCryptoError result = WC_CRYPTO_FAILURE;
+    int len = 0;
+    unsigned char dummy[16]; /* GCM final produces no output bytes */
+
+    if (EVP_EncryptFinal_ex(stream->evp, dummy, &len) == 1 &&
+        EVP_CIPHER_CTX_ctrl(stream->evp, EVP_CTRL_GCM_GET_TAG, tag_len, tag) == 1) {
+        result = WC_CRYPTO_SUCCESS;
+    }
+
+    wc_crypto_stream_abort(stream);
+    return result;
+}
+
+WCCryptoError wc_decrypt_stream_final(
+    WorkChainCryptoStream *stream,
+    const unsigned char *tag,
+    size_t tag_len)
+{
+    if (!stream || !tag || tag_len < 16 || stream->encrypting) {
+        if (stream) wc_crypto_stream_abort(stream);
+        return WC_CRYPTO_INVALID_INPUT;
+    }
+
+    WCCryptoError result = WC_CRYPTO_AUTH_FAILED;
+    int len = 0;
+    unsigned char dummy[16];
+
+    if (EVP_CIPHER_CTX_ctrl(stream->evp, EVP_CTRL_GCM_SET_TAG, (int)tag_len, (void*)tag) == 1 &&
+        EVP_DecryptFinal_ex(stream->evp, dummy, &len) > 0) {
+        result = WC_CRYPTO_SUCCESS;
+    }
+
+    wc_crypto_stream_abort(stream);
+    return result;
+}
+
+void wc_crypto_stream_abort(WorkChainCryptoStream *stream)
+{
+    if (!stream) return;
+    if (stream->evp) EVP_CIPHER_CTX_free(stream->evp);
+    free(stream);
+}
+
 /* SHA-256 Hashing */
 WCCryptoError wc_hash_sha256(
     const unsigned char *data,
@@ -323,6 +962,646 @@ WCCryptoError wc_hmac_sha256(
     return WC_CRYPTO_SUCCESS;
 }
 
+/* * Bulk parallel GCM: segment workers.
+ * Each worker owns one EVP context for its whole share of the stream and
+ * re-inits it per segment with the IV only (the key schedule is expanded
+ * once), striding segments round-robin so a tail of short segments does
+ * not serialize on one thread. VAES/AVX-512 block parallelism inside a
+ * segment comes from OpenSSL's fetched implementation; the threads add
+ * segment-level parallelism on top.
+ */
+typedef struct {
+    WorkChainCryptoContext *ctx;
+    const unsigned char *input;
+    unsigned char *output;
+    const unsigned char *aad;
+    size_t aad_len;
+    WCBulkSegmentRecord *manifest;     /* decrypt: const, cast back */
+    size_t segment_count;
+    size_t stride;                     /* worker count */
+    size_t first_segment;              /* this worker's starting index */
+    int encrypting;
+    WCCryptoError result;
+} WCBulkJob;
+
+static void* wc_bulk_worker(void *arg)
+{
+    WCBulkJob *job = (WCBulkJob*)arg;
+    job->result = WC_CRYPTO_SUCCESS;
+
+    EVP_CIPHER_CTX *evp = EVP_CIPHER_CTX_new();
+    if (!evp) {
+        job->result = WC_CRYPTO_MEMORY_ERROR;
+        return NULL;
+    }
+
+    int keyed = 0;
+    for (size_t i = job->first_segment; i < job->segment_count; i += job->stride) {
+        WCBulkSegmentRecord *seg = &job->manifest[i];
+        const unsigned char *in = job->input + seg->offset;
+        unsigned char *out = job->output + seg->offset;
+        int len;
+        int ok;
+
+        if (job->encrypting && wc_next_iv(job->ctx, seg->iv) != WC_CRYPTO_SUCCESS) {
+            job->result = WC_CRYPTO_FAILURE;
+            break;
+        }
+
+        /* Full init once per worker; IV-only re-init per segment */
+        if (!keyed) {
+            ok = job->encrypting
+                ? EVP_EncryptInit_ex(evp, EVP_aes_256_gcm(), NULL, job->ctx->key, seg->iv)
+                : EVP_DecryptInit_ex(evp, EVP_aes_256_gcm(), NULL, job->ctx->key, seg->iv);
+            keyed = 1;
+        } else {
+            ok = job->encrypting
+                ? EVP_EncryptInit_ex(evp, NULL, NULL, NULL, seg->iv)
+                : EVP_DecryptInit_ex(evp, NULL, NULL, NULL, seg->iv);
+        }
+        if (ok != 1) {
+            job->result = WC_CRYPTO_FAILURE;
+            break;
+        }
+
+        if (job->aad && job->aad_len > 0) {
+            ok = job->encrypting
+                ? EVP_EncryptUpdate(evp, NULL, &len, job->aad, job->aad_len)
+                : EVP_DecryptUpdate(evp, NULL, &len, job->aad, job->aad_len);
+            if (ok != 1) {
+                job->result = WC_CRYPTO_FAILURE;
+                break;
+            }
+        }
+
+        if (job->encrypting) {
+            if (EVP_EncryptUpdate(evp, out, &len, in, (int)seg->length) != 1 ||
+                EVP_EncryptFinal_ex(evp, out + len, &len) != 1 ||
+                EVP_CIPHER_CTX_ctrl(evp, EVP_CTRL_GCM_GET_TAG, 16, seg->tag) != 1) {
+                job->result = WC_CRYPTO_FAILURE;
+                break;
+            }
+        } else {
+            if (EVP_DecryptUpdate(evp, out, &len, in, (int)seg->length) != 1 ||
+                EVP_CIPHER_CTX_ctrl(evp, EVP_CTRL_GCM_SET_TAG, 16, (void*)seg->tag) != 1) {
+                job->result = WC_CRYPTO_FAILURE;
+                break;
+            }
+            if (EVP_DecryptFinal_ex(evp, out + len, &len) <= 0) {
+                job->result = WC_CRYPTO_AUTH_FAILED;
+                break;
+            }
+        }
+    }
+
+    EVP_CIPHER_CTX_free(evp);
+    return NULL;
+}
+
+static double wc_bulk_elapsed_seconds(const struct timespec *start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (double)(end.tv_sec - start->tv_sec)
+         + (double)(end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static WCCryptoError wc_bulk_run(
+    WorkChainCryptoContext *ctx,
+    const unsigned char *input, size_t input_len,
+    const unsigned char *aad, size_t aad_len,
+    unsigned char *output,
+    WCBulkSegmentRecord *manifest, size_t segment_count,
+    int num_threads, int encrypting,
+    double *throughput_mbps)
+{
+    if (num_threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (cpus > 0) ? (int)cpus : 1;
+    }
+    if (num_threads > WC_BULK_MAX_THREADS) num_threads = WC_BULK_MAX_THREADS;
+    if ((size_t)num_threads > segment_count) num_threads = (int)segment_count;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    WCBulkJob jobs[WC_BULK_MAX_THREADS];
+    pthread_t threads[WC_BULK_MAX_THREADS];
+
+    for (int t = 0; t < num_threads; t++) {
+        jobs[t].ctx = ctx;
+        jobs[t].input = input;
+        jobs[t].output = output;
+        jobs[t].aad = aad;
+        jobs[t].aad_len = aad_len;
+        jobs[t].manifest = manifest;
+        jobs[t].segment_count = segment_count;
+        jobs[t].stride = (size_t)num_threads;
+        jobs[t].first_segment = (size_t)t;
+        jobs[t].encrypting = encrypting;
+        jobs[t].result = WC_CRYPTO_SUCCESS;
+    }
+
+    int spawned = 0;
+    for (int t = 1; t < num_threads; t++) {
+        if (pthread_create(&threads[t], NULL, wc_bulk_worker, &jobs[t]) != 0) break;
+        spawned = t;
+    }
+    wc_bulk_worker(&jobs[0]); /* this thread is worker 0 */
+    for (int t = 1; t <= spawned; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    /* Workers that never got a thread still hold their segments: run
+       them inline so the stream is complete even under thread pressure */
+    for (int t = spawned + 1; t < num_threads; t++) {
+        wc_bulk_worker(&jobs[t]);
+    }
+
+    WCCryptoError rc = WC_CRYPTO_SUCCESS;
+    for (int t = 0; t < num_threads; t++) {
+        if (jobs[t].result != WC_CRYPTO_SUCCESS && rc != WC_CRYPTO_AUTH_FAILED) {
+            /* Auth failure dominates other errors in the report */
+            rc = jobs[t].result;
+        }
+    }
+
+    if (rc == WC_CRYPTO_AUTH_FAILED && !encrypting) {
+        OPENSSL_cleanse(output, input_len); /* no partial plaintext escapes */
+    }
+
+    if (throughput_mbps) {
+        double seconds = wc_bulk_elapsed_seconds(&start);
+        *throughput_mbps = (seconds > 0.0)
+            ? ((double)input_len / (1024.0 * 1024.0)) / seconds
+            : 0.0;
+    }
+
+    return rc;
+}
+
+WCCryptoError wc_encrypt_bulk(
+    WorkChainCryptoContext *ctx,
+    const unsigned char *plaintext,
+    size_t plaintext_len,
+    const unsigned char *aad,
+    size_t aad_len,
+    unsigned char *ciphertext,
+    size_t segment_len,
+    int num_threads,
+    WCBulkSegmentRecord *manifest,
+    size_t *segment_count,
+    double *throughput_mbps)
+{
+    if (!ctx || !plaintext || !ciphertext || !manifest || !segment_count ||
+        plaintext_len == 0) {
+        return WC_CRYPTO_INVALID_INPUT;
+    }
+    if (segment_len == 0) segment_len = WC_BULK_DEFAULT_SEGMENT;
+    if (segment_len > INT_MAX) return WC_CRYPTO_INVALID_INPUT;
+
+    size_t needed = (plaintext_len + segment_len - 1) / segment_len;
+    if (*segment_count < needed) {
+        *segment_count = needed; /* tell the caller the required capacity */
+        return WC_CRYPTO_OVERFLOW;
+    }
+
+    for (size_t i = 0; i < needed; i++) {
+        manifest[i].offset = (uint64_t)i * segment_len;
+        manifest[i].length = (i + 1 == needed)
+            ? (uint64_t)(plaintext_len - manifest[i].offset)
+            : (uint64_t)segment_len;
+    }
+    *segment_count = needed;
+
+    return wc_bulk_run(ctx, plaintext, plaintext_len, aad, aad_len, ciphertext,
+                       manifest, needed, num_threads, 1, throughput_mbps);
+}
+
+WCCryptoError wc_decrypt_bulk(
+    WorkChainCryptoContext *ctx,
+    const unsigned char *ciphertext,
+    size_t ciphertext_len,
+    const unsigned char *aad,
+    size_t aad_len,
+    unsigned char *plaintext,
+    const WCBulkSegmentRecord *manifest,
+    size_t segment_count,
+    int num_threads,
+    double *throughput_mbps)
+{
+    if (!ctx || !ciphertext || !plaintext || !manifest || segment_count == 0) {
+        return WC_CRYPTO_INVALID_INPUT;
+    }
+
+    /* The manifest must tile the ciphertext exactly */
+    uint64_t covered = 0;
+    for (size_t i = 0; i < segment_count; i++) {
+        if (manifest[i].offset != covered || manifest[i].length == 0 ||
+            manifest[i].length > INT_MAX) {
+            return WC_CRYPTO_INVALID_INPUT;
+        }
+        covered += manifest[i].length;
+    }
+    if (covered != (uint64_t)ciphertext_len) return WC_CRYPTO_INVALID_INPUT;
+
+    /* Workers only read the manifest on the decrypt path */
+    return wc_bulk_run(ctx, ciphertext, ciphertext_len, aad, aad_len, plaintext,
+                       (WCBulkSegmentRecord*)manifest, segment_count,
+                       num_threads, 0, throughput_mbps);
+}
+
+/* * Batch HMAC-SHA256: one key schedule, n messages.
+ * We build a single keyed EVP_MAC context (the expensive part: two
+ * SHA-256 compressions over ipad/opad) and duplicate it per message, so
+ * each short audit record costs only its own data blocks plus the final.
+ * OpenSSL's fetched HMAC/SHA-256 providers pick the fastest compression
+ * the CPU offers (SHA-NI, AVX2), so independent messages already run on
+ * the accelerated single-buffer path; an explicit multi-buffer scheduler
+ * is not exposed at this API level.
+ */
+WCCryptoError wc_hmac_sha256_batch(
+    const unsigned char *key,
+    size_t key_len,
+    const unsigned char **msgs,
+    const size_t *msg_lens,
+    unsigned char **out,
+    size_t n)
+{
+    if (!key || !msgs || !msg_lens || !out || n == 0) {
+        return WC_CRYPTO_INVALID_INPUT;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (!msgs[i] || !out[i]) {
+            return WC_CRYPTO_INVALID_INPUT;
+        }
+    }
+
+    EVP_MAC *mac = EVP_MAC_fetch(NULL, "HMAC", NULL);
+    if (!mac) return WC_CRYPTO_FAILURE;
+
+    EVP_MAC_CTX *tmpl = EVP_MAC_CTX_new(mac);
+    if (!tmpl) {
+        EVP_MAC_free(mac);
+        return WC_CRYPTO_MEMORY_ERROR;
+    }
+
+    OSSL_PARAM params[2];
+    params[0] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, "SHA256", 0);
+    params[1] = OSSL_PARAM_construct_end();
+
+    /* Keying the template runs the ipad/opad compressions exactly once */
+    if (EVP_MAC_init(tmpl, key, key_len, params) != 1) {
+        EVP_MAC_CTX_free(tmpl);
+        EVP_MAC_free(mac);
+        return WC_CRYPTO_FAILURE;
+    }
+
+    WCCryptoError rc = WC_CRYPTO_SUCCESS;
+
+    for (size_t i = 0; i < n; i++) {
+        EVP_MAC_CTX *work = EVP_MAC_CTX_dup(tmpl);
+        if (!work) {
+            rc = WC_CRYPTO_MEMORY_ERROR;
+            break;
+        }
+
+        size_t digest_len = 0;
+        if (EVP_MAC_update(work, msgs[i], msg_lens[i]) != 1 ||
+            EVP_MAC_final(work, out[i], &digest_len, 32) != 1 ||
+            digest_len != 32) {
+            EVP_MAC_CTX_free(work);
+            rc = WC_CRYPTO_FAILURE;
+            break;
+        }
+
+        EVP_MAC_CTX_free(work);
+    }
+
+    EVP_MAC_CTX_free(tmpl);
+    EVP_MAC_free(mac);
+
+    return rc;
+}
+
+/* * PBKDF2 derivation service: worker pool + secure result cache.
+ *
+ * Cache entries are keyed by SHA-512/256-truncated digest of
+ * (password, salt, iterations, dklen) so the plaintext password is never
+ * stored; slots are direct-indexed with a short linear probe, and any
+ * overwrite, expiry or shutdown cleanses the derived key bytes.
+ */
+#define WC_PBKDF2_MAX_PASSWORD   256
+#define WC_PBKDF2_MAX_SALT       64
+#define WC_PBKDF2_MAX_KEY        64
+#define WC_PBKDF2_QUEUE_DEPTH    256
+#define WC_PBKDF2_CACHE_PROBES   4
+
+typedef struct {
+    unsigned char password[WC_PBKDF2_MAX_PASSWORD];
+    size_t password_len;
+    unsigned char salt[WC_PBKDF2_MAX_SALT];
+    size_t salt_len;
+    int iterations;
+    size_t derived_key_len;
+    WCDeriveCallback callback;
+    void *user_data;
+} WCDeriveRequest;
+
+typedef struct {
+    unsigned char id[32];                  /* digest of the request inputs */
+    unsigned char key[WC_PBKDF2_MAX_KEY];
+    size_t key_len;
+    time_t expiry;
+    int used;
+} WCDeriveCacheSlot;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_t workers[16];
+    int num_workers;
+    int running;
+    int stopping;
+
+    WCDeriveRequest queue[WC_PBKDF2_QUEUE_DEPTH];
+    size_t queue_head;
+    size_t queue_count;
+
+    WCDeriveCacheSlot *cache;
+    size_t cache_slots;
+    unsigned int cache_ttl;
+} wc_pbkdf2_service = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .not_empty = PTHREAD_COND_INITIALIZER,
+};
+
+/* Digest of (password, salt, iterations, dklen): never store the password */
+static WCCryptoError wc_pbkdf2_cache_id(
+    const unsigned char *password, size_t password_len,
+    const unsigned char *salt, size_t salt_len,
+    int iterations, size_t derived_key_len,
+    unsigned char id[32])
+{
+    unsigned char input[WC_PBKDF2_MAX_PASSWORD + WC_PBKDF2_MAX_SALT + 2 * sizeof(uint64_t)];
+    uint64_t meta[2] = { (uint64_t)iterations, (uint64_t)derived_key_len };
+    size_t off = 0;
+
+    memcpy(input + off, password, password_len); off += password_len;
+    memcpy(input + off, salt, salt_len);         off += salt_len;
+    memcpy(input + off, meta, sizeof(meta));     off += sizeof(meta);
+
+    unsigned int id_len = 0;
+    int ok = EVP_Digest(input, off, id, &id_len, EVP_sha256(), NULL);
+    OPENSSL_cleanse(input, off);
+
+    return (ok == 1 && id_len == 32) ? WC_CRYPTO_SUCCESS : WC_CRYPTO_FAILURE;
+}
+
+/* Caller holds the service lock */
+static int wc_pbkdf2_cache_lookup(
+    const unsigned char id[32],
+    unsigned char *key_out, size_t derived_key_len)
+{
+    if (!wc_pbkdf2_service.cache) return 0;
+
+    time_t now = time(NULL);
+    size_t base;
+    memcpy(&base, id, sizeof(base));
+
+    for (size_t p = 0; p < WC_PBKDF2_CACHE_PROBES; p++) {
+        WCDeriveCacheSlot *slot =
+            &wc_pbkdf2_service.cache[(base + p) % wc_pbkdf2_service.cache_slots];
+        if (!slot->used) continue;
+        if (slot->expiry <= now) {
+            OPENSSL_cleanse(slot, sizeof(*slot));
+            continue;
+        }
+        if (memcmp(slot->id, id, 32) == 0 && slot->key_len == derived_key_len) {
+            memcpy(key_out, slot->key, derived_key_len);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Caller holds the service lock. Overwrites the first free/expired probe
+   slot, or the probe slot closest to expiry if all are live. */
+static void wc_pbkdf2_cache_insert(
+    const unsigned char id[32],
+    const unsigned char *key, size_t key_len)
+{
+    if (!wc_pbkdf2_service.cache) return;
+
+    time_t now = time(NULL);
+    size_t base;
+    memcpy(&base, id, sizeof(base));
+
+    WCDeriveCacheSlot *victim = NULL;
+    for (size_t p = 0; p < WC_PBKDF2_CACHE_PROBES; p++) {
+        WCDeriveCacheSlot *slot =
+            &wc_pbkdf2_service.cache[(base + p) % wc_pbkdf2_service.cache_slots];
+        if (!slot->used || slot->expiry <= now) {
+            victim = slot;
+            break;
+        }
+        if (!victim || slot->expiry < victim->expiry) {
+            victim = slot;
+        }
+    }
+
+    OPENSSL_cleanse(victim, sizeof(*victim));
+    memcpy(victim->id, id, 32);
+    memcpy(victim->key, key, key_len);
+    victim->key_len = key_len;
+    victim->expiry = now + wc_pbkdf2_service.cache_ttl;
+    victim->used = 1;
+}
+
+static void* wc_pbkdf2_worker(void *arg)
+{
+    (void)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&wc_pbkdf2_service.lock);
+        while (wc_pbkdf2_service.queue_count == 0 && !wc_pbkdf2_service.stopping) {
+            pthread_cond_wait(&wc_pbkdf2_service.not_empty, &wc_pbkdf2_service.lock);
+        }
+        if (wc_pbkdf2_service.queue_count == 0 && wc_pbkdf2_service.stopping) {
+            pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+            return NULL;
+        }
+
+        WCDeriveRequest req = wc_pbkdf2_service.queue[wc_pbkdf2_service.queue_head];
+        OPENSSL_cleanse(&wc_pbkdf2_service.queue[wc_pbkdf2_service.queue_head], sizeof(WCDeriveRequest));
+        wc_pbkdf2_service.queue_head = (wc_pbkdf2_service.queue_head + 1) % WC_PBKDF2_QUEUE_DEPTH;
+        wc_pbkdf2_service.queue_count--;
+
+        unsigned char id[32];
+        unsigned char key[WC_PBKDF2_MAX_KEY];
+        int have_id = (wc_pbkdf2_cache_id(req.password, req.password_len,
+                                          req.salt, req.salt_len,
+                                          req.iterations, req.derived_key_len,
+                                          id) == WC_CRYPTO_SUCCESS);
+        int hit = have_id && wc_pbkdf2_cache_lookup(id, key, req.derived_key_len);
+        pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+
+        WCCryptoError rc = WC_CRYPTO_SUCCESS;
+        if (!hit) {
+            if (PKCS5_PBKDF2_HMAC((const char*)req.password, req.password_len,
+                                  req.salt, req.salt_len, req.iterations,
+                                  EVP_sha512(), req.derived_key_len, key) != 1) {
+                rc = WC_CRYPTO_FAILURE;
+            } else if (have_id) {
+                pthread_mutex_lock(&wc_pbkdf2_service.lock);
+                wc_pbkdf2_cache_insert(id, key, req.derived_key_len);
+                pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+            }
+        }
+
+        if (req.callback) {
+            req.callback(rc,
+                         rc == WC_CRYPTO_SUCCESS ? key : NULL,
+                         rc == WC_CRYPTO_SUCCESS ? req.derived_key_len : 0,
+                         req.user_data);
+        }
+
+        OPENSSL_cleanse(key, sizeof(key));
+        OPENSSL_cleanse(&req, sizeof(req));
+    }
+}
+
+WCCryptoError wc_pbkdf2_service_start(
+    int num_workers,
+    size_t cache_slots,
+    unsigned int cache_ttl_seconds)
+{
+    if (num_workers < 1 || num_workers > 16) {
+        return WC_CRYPTO_INVALID_INPUT;
+    }
+
+    pthread_mutex_lock(&wc_pbkdf2_service.lock);
+    if (wc_pbkdf2_service.running) {
+        pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+        return WC_CRYPTO_INVALID_INPUT;
+    }
+
+    if (cache_slots > 0) {
+        wc_pbkdf2_service.cache =
+            (WCDeriveCacheSlot*)calloc(cache_slots, sizeof(WCDeriveCacheSlot));
+        if (!wc_pbkdf2_service.cache) {
+            pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+            return WC_CRYPTO_MEMORY_ERROR;
+        }
+    }
+    wc_pbkdf2_service.cache_slots = cache_slots;
+    wc_pbkdf2_service.cache_ttl = cache_ttl_seconds;
+    wc_pbkdf2_service.queue_head = 0;
+    wc_pbkdf2_service.queue_count = 0;
+    wc_pbkdf2_service.stopping = 0;
+    wc_pbkdf2_service.num_workers = num_workers;
+
+    for (int i = 0; i < num_workers; i++) {
+        if (pthread_create(&wc_pbkdf2_service.workers[i], NULL, wc_pbkdf2_worker, NULL) != 0) {
+            wc_pbkdf2_service.stopping = 1;
+            pthread_cond_broadcast(&wc_pbkdf2_service.not_empty);
+            pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+            for (int j = 0; j < i; j++) {
+                pthread_join(wc_pbkdf2_service.workers[j], NULL);
+            }
+            pthread_mutex_lock(&wc_pbkdf2_service.lock);
+            free(wc_pbkdf2_service.cache);
+            wc_pbkdf2_service.cache = NULL;
+            wc_pbkdf2_service.stopping = 0;
+            pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+            return WC_CRYPTO_FAILURE;
+        }
+    }
+
+    wc_pbkdf2_service.running = 1;
+    pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+    return WC_CRYPTO_SUCCESS;
+}
+
+void wc_pbkdf2_service_stop(void)
+{
+    pthread_mutex_lock(&wc_pbkdf2_service.lock);
+    if (!wc_pbkdf2_service.running) {
+        pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+        return;
+    }
+    wc_pbkdf2_service.stopping = 1;
+    pthread_cond_broadcast(&wc_pbkdf2_service.not_empty);
+    int workers = wc_pbkdf2_service.num_workers;
+    pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+
+    for (int i = 0; i < workers; i++) {
+        pthread_join(wc_pbkdf2_service.workers[i], NULL);
+    }
+
+    pthread_mutex_lock(&wc_pbkdf2_service.lock);
+    if (wc_pbkdf2_service.cache) {
+        for (size_t i = 0; i < wc_pbkdf2_service.cache_slots; i++) {
+            OPENSSL_cleanse(&wc_pbkdf2_service.cache[i], sizeof(WCDeriveCacheSlot));
+        }
+        free(wc_pbkdf2_service.cache);
+        wc_pbkdf2_service.cache = NULL;
+    }
+    for (size_t i = 0; i < WC_PBKDF2_QUEUE_DEPTH; i++) {
+        OPENSSL_cleanse(&wc_pbkdf2_service.queue[i], sizeof(WCDeriveRequest));
+    }
+    wc_pbkdf2_service.queue_count = 0;
+    wc_pbkdf2_service.running = 0;
+    wc_pbkdf2_service.stopping = 0;
+    pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+}
+
+WCCryptoError wc_derive_key_pbkdf2_async(
+    const unsigned char *password,
+    size_t password_len,
+    const unsigned char *salt,
+    size_t salt_len,
+    int iterations,
+    size_t derived_key_len,
+    WCDeriveCallback callback,
+    void *user_data)
+{
+    if (!password || !salt || !callback || iterations < 10000 ||
+        password_len == 0 || password_len > WC_PBKDF2_MAX_PASSWORD ||
+        salt_len == 0 || salt_len > WC_PBKDF2_MAX_SALT ||
+        derived_key_len == 0 || derived_key_len > WC_PBKDF2_MAX_KEY) {
+        return WC_CRYPTO_INVALID_INPUT;
+    }
+
+    pthread_mutex_lock(&wc_pbkdf2_service.lock);
+    if (!wc_pbkdf2_service.running || wc_pbkdf2_service.stopping) {
+        pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+        return WC_CRYPTO_FAILURE;
+    }
+    if (wc_pbkdf2_service.queue_count == WC_PBKDF2_QUEUE_DEPTH) {
+        pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+        return WC_CRYPTO_OVERFLOW; /* back-pressure: shed the login, don't block */
+    }
+
+    size_t tail = (wc_pbkdf2_service.queue_head + wc_pbkdf2_service.queue_count)
+                  % WC_PBKDF2_QUEUE_DEPTH;
+    WCDeriveRequest *req = &wc_pbkdf2_service.queue[tail];
+    memcpy(req->password, password, password_len);
+    req->password_len = password_len;
+    memcpy(req->salt, salt, salt_len);
+    req->salt_len = salt_len;
+    req->iterations = iterations;
+    req->derived_key_len = derived_key_len;
+    req->callback = callback;
+    req->user_data = user_data;
+    wc_pbkdf2_service.queue_count++;
+
+    pthread_cond_signal(&wc_pbkdf2_service.not_empty);
+    pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+    return WC_CRYPTO_SUCCESS;
+}
+
 /* PBKDF2 Key Derivation */
 WCCryptoError wc_derive_key_pbkdf2(
     const unsigned char *password,
@@ -337,11 +1616,38 @@ WCCryptoError wc_derive_key_pbkdf2(
         return WC_CRYPTO_INVALID_INPUT;
     }
 
+    /* Session re-verification hits the derivation cache when the service
+       is running; a cold miss still derives inline */
+    unsigned char id[32];
+    int have_id = 0;
+    if (password_len <= WC_PBKDF2_MAX_PASSWORD && salt_len <= WC_PBKDF2_MAX_SALT &&
+        derived_key_len <= WC_PBKDF2_MAX_KEY) {
+        pthread_mutex_lock(&wc_pbkdf2_service.lock);
+        if (wc_pbkdf2_service.running && wc_pbkdf2_service.cache) {
+            have_id = (wc_pbkdf2_cache_id(password, password_len, salt, salt_len,
+                                          iterations, derived_key_len, id)
+                       == WC_CRYPTO_SUCCESS);
+            if (have_id && wc_pbkdf2_cache_lookup(id, derived_key, derived_key_len)) {
+                pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+                return WC_CRYPTO_SUCCESS;
+            }
+        }
+        pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+    }
+
     if (PKCS5_PBKDF2_HMAC((const char*)password, password_len, salt, salt_len,
                            iterations, EVP_sha512(), derived_key_len, derived_key) != 1) {
         return WC_CRYPTO_FAILURE;
     }
 
+    if (have_id) {
+        pthread_mutex_lock(&wc_pbkdf2_service.lock);
+        if (wc_pbkdf2_service.running) {
+            wc_pbkdf2_cache_insert(id, derived_key, derived_key_len);
+        }
+        pthread_mutex_unlock(&wc_pbkdf2_service.lock);
+    }
+
     return WC_CRYPTO_SUCCESS;
 }
 
@@ -352,11 +1658,7 @@ WCCryptoError wc_random_bytes(unsigned char *buf, size_t buf_len)
         return WC_CRYPTO_INVALID_INPUT;
     }
 
-    if (RAND_bytes(buf, buf_len) != 1) {
-        return WC_CRYPTO_FAILURE;
-    }
-
-    return WC_CRYPTO_SUCCESS;
+    return wc_thread_random(buf, buf_len);
 }
 
 /* Constant-time comparison */
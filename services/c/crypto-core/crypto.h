@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <sys/uio.h>
 #include <openssl/evp.h>
 #include <openssl/rand.h>
 #include <openssl/sha.h>
@@ -15,6 +16,13 @@ typedef struct {
     unsigned char key[32];      /* 256-bit key */
     unsigned char iv[16];       /* 128-bit IV (Storage only) */
     unsigned char salt[16];     /* 128-bit salt */
+
+    /* Deterministic IV construction (NIST SP 800-38D section 8.2.1):
+       a random 32-bit fixed field chosen per context plus a 64-bit
+       invocation counter. Zero deterministic_iv = random IVs. */
+    unsigned char iv_prefix[4];
+    uint64_t iv_counter;        /* advanced atomically */
+    int deterministic_iv;
 } WorkChainCryptoContext;
 
 /* Secure memory structure */
@@ -69,6 +77,156 @@ WCCryptoError wc_decrypt_aes256gcm(
     size_t tag_len
 );
 
+/* * Scatter-gather AES-256-GCM.
+ * The REST gateway hands us request bodies as chains of network buffers;
+ * flattening them into one contiguous staging buffer before the one-shot
+ * call costs a full extra copy of every payload. The iov variants feed
+ * each region straight into the cipher, so the only bytes written are
+ * ciphertext. Framing and semantics match the one-shot calls exactly
+ * (fresh 96-bit IV, output is IV || body, same Org-ID AAD binding) —
+ * the two forms interoperate. AAD is a region list too, so the Org ID
+ * and any routing headers can be bound without concatenation.
+ *
+ * For decryption the IV is gathered from the first 12 bytes of the
+ * region chain, wherever the region boundaries fall. plaintext must have
+ * room for the summed region lengths minus the IV; on tag or AAD
+ * mismatch the output is wiped and WC_CRYPTO_AUTH_FAILED returned.
+ */
+WCCryptoError wc_encrypt_aes256gcm_iov(
+    WorkChainCryptoContext *ctx,
+    const struct iovec *in,        /* plaintext regions */
+    int iovcnt,
+    const struct iovec *aad,       /* Org ID + bound headers, may be NULL */
+    int aadcnt,
+    unsigned char *ciphertext,     /* 12 + summed region lengths */
+    size_t *ciphertext_len,
+    unsigned char *tag,
+    size_t tag_len
+);
+
+WCCryptoError wc_decrypt_aes256gcm_iov(
+    WorkChainCryptoContext *ctx,
+    const struct iovec *in,        /* IV || ciphertext body regions */
+    int iovcnt,
+    const struct iovec *aad,
+    int aadcnt,
+    unsigned char *plaintext,
+    size_t *plaintext_len,
+    const unsigned char *tag,
+    size_t tag_len
+);
+
+/* * Streaming AES-256-GCM.
+ * One-shot wc_encrypt_aes256gcm needs the whole message in memory and is
+ * capped at the SecureBuffer sanity limit; the stream API processes data
+ * in caller-sized chunks with constant memory, so multi-hundred-MB
+ * document bundles can be piped disk-to-disk through encryption.
+ *
+ * Usage (encrypt): init -> write the 12-byte IV wherever the framing
+ * wants it -> update per chunk -> final (emits the tag and frees the
+ * stream). Decrypt mirrors it: pass the IV to init and the expected tag
+ * to final; final returns WC_CRYPTO_AUTH_FAILED on tag/AAD mismatch.
+ * A stream is single-use; init always allocates a fresh one and
+ * final/abort always releases it.
+ */
+typedef struct WorkChainCryptoStream WorkChainCryptoStream;
+
+WorkChainCryptoStream* wc_encrypt_stream_init(
+    WorkChainCryptoContext *ctx,
+    const unsigned char *aad,      /* Org ID binding, may be NULL */
+    size_t aad_len,
+    unsigned char *iv_out          /* receives the generated 12-byte IV */
+);
+
+WorkChainCryptoStream* wc_decrypt_stream_init(
+    WorkChainCryptoContext *ctx,
+    const unsigned char *aad,
+    size_t aad_len,
+    const unsigned char *iv        /* the 12-byte IV from encryption */
+);
+
+/* out must have room for in_len bytes (GCM is length-preserving) */
+WCCryptoError wc_crypto_stream_update(
+    WorkChainCryptoStream *stream,
+    const unsigned char *in,
+    size_t in_len,
+    unsigned char *out,
+    size_t *out_len
+);
+
+/* Encrypt: emits the authentication tag. Frees the stream. */
+WCCryptoError wc_encrypt_stream_final(
+    WorkChainCryptoStream *stream,
+    unsigned char *tag,
+    size_t tag_len
+);
+
+/* Decrypt: verifies the expected tag. Frees the stream. */
+WCCryptoError wc_decrypt_stream_final(
+    WorkChainCryptoStream *stream,
+    const unsigned char *tag,
+    size_t tag_len
+);
+
+/* Releases a stream without finalizing (error/cancel paths) */
+void wc_crypto_stream_abort(WorkChainCryptoStream *stream);
+
+/* * Bulk parallel AES-256-GCM for the nightly table export.
+ * One logical stream is split into fixed-size segments, each encrypted
+ * independently (own random 96-bit IV, own tag) on a pool of worker
+ * threads; the per-segment IVs/tags/extents come back in a manifest the
+ * decrypt side verifies segment by segment. Within a segment the work
+ * runs on OpenSSL's fetched AES-GCM, which pins the widest pipeline the
+ * CPU offers (AES-NI, VAES/AVX-512); across segments the threads give
+ * the multi-GB/s the hardware can do but a single core cannot.
+ *
+ * ciphertext holds only the body (same length as plaintext) — framing
+ * lives in the manifest, which the caller persists alongside. manifest
+ * must have room for ceil(plaintext_len / segment_len) records;
+ * *segment_count carries the capacity in and the used count out.
+ * segment_len 0 selects the default (64 MiB), num_threads 0 sizes the
+ * pool to the machine. throughput_mbps (optional) reports the achieved
+ * end-to-end rate for the export job's SLA accounting.
+ */
+#define WC_BULK_DEFAULT_SEGMENT (64 * 1024 * 1024)
+#define WC_BULK_MAX_THREADS 16
+
+typedef struct {
+    unsigned char iv[12];
+    unsigned char tag[16];
+    uint64_t offset;           /* byte offset of the segment in the stream */
+    uint64_t length;
+} WCBulkSegmentRecord;
+
+WCCryptoError wc_encrypt_bulk(
+    WorkChainCryptoContext *ctx,
+    const unsigned char *plaintext,
+    size_t plaintext_len,
+    const unsigned char *aad,          /* Org ID binding, applied per segment */
+    size_t aad_len,
+    unsigned char *ciphertext,         /* plaintext_len bytes */
+    size_t segment_len,
+    int num_threads,
+    WCBulkSegmentRecord *manifest,
+    size_t *segment_count,
+    double *throughput_mbps            /* may be NULL */
+);
+
+/* Verifies and decrypts every manifest segment; fails with
+   WC_CRYPTO_AUTH_FAILED (and wipes the output) if any tag mismatches */
+WCCryptoError wc_decrypt_bulk(
+    WorkChainCryptoContext *ctx,
+    const unsigned char *ciphertext,
+    size_t ciphertext_len,
+    const unsigned char *aad,
+    size_t aad_len,
+    unsigned char *plaintext,          /* ciphertext_len bytes */
+    const WCBulkSegmentRecord *manifest,
+    size_t segment_count,
+    int num_threads,
+    double *throughput_mbps
+);
+
 /* Hashing (SHA-256) */
 WCCryptoError wc_hash_sha256(
     const unsigned char *data,
@@ -95,6 +253,26 @@ WCCryptoError wc_hmac_sha256(
     size_t *hmac_len
 );
 
+/* * Batch HMAC-SHA256.
+ * The one-at-a-time wc_hmac_sha256 re-derives the ipad/opad key state for
+ * every message, which is most of the cost when the messages are short
+ * (audit-log mutation records). The batch form expands the key once and
+ * stamps each message from a copy of that precomputed state; the hashing
+ * itself goes through OpenSSL's fetched SHA-256, which selects SHA-NI /
+ * vectorized compression where the CPU has it.
+ *
+ * msgs[i]/msg_lens[i] describe message i; out[i] must have room for a
+ * 32-byte digest. Fails atomically: on error no digest is valid.
+ */
+WCCryptoError wc_hmac_sha256_batch(
+    const unsigned char *key,
+    size_t key_len,
+    const unsigned char **msgs,
+    const size_t *msg_lens,
+    unsigned char **out,
+    size_t n
+);
+
 /* Key derivation (PBKDF2) */
 WCCryptoError wc_derive_key_pbkdf2(
     const unsigned char *password,
@@ -106,7 +284,66 @@ WCCryptoError wc_derive_key_pbkdf2(
     size_t derived_key_len
 );
 
-/* Random number generation */
+/* * PBKDF2 derivation service.
+ * A synchronous wc_derive_key_pbkdf2 at production iteration counts pins
+ * a worker thread for hundreds of milliseconds; a login burst can stall
+ * the whole auth service. The service moves derivation onto a bounded
+ * pool of background workers with a completion callback, and keeps a
+ * TTL'd in-memory cache keyed by a digest of (password, salt,
+ * iterations, key length) so repeat verifications of an active session
+ * cost a lookup instead of the full iteration count. Cached keys are
+ * OPENSSL_cleanse'd on eviction, expiry and shutdown. While the service
+ * is running, wc_derive_key_pbkdf2 also consults the cache.
+ *
+ * The callback runs on a worker thread; it must not block for long.
+ * wc_derive_key_pbkdf2_async returns WC_CRYPTO_OVERFLOW when the queue
+ * is full — callers should treat that as back-pressure, not failure.
+ */
+typedef void (*WCDeriveCallback)(
+    WCCryptoError status,
+    const unsigned char *derived_key,  /* valid only during the callback */
+    size_t derived_key_len,
+    void *user_data
+);
+
+WCCryptoError wc_pbkdf2_service_start(
+    int num_workers,               /* 1..16 */
+    size_t cache_slots,            /* 0 disables the cache */
+    unsigned int cache_ttl_seconds
+);
+
+void wc_pbkdf2_service_stop(void);
+
+WCCryptoError wc_derive_key_pbkdf2_async(
+    const unsigned char *password,
+    size_t password_len,
+    const unsigned char *salt,
+    size_t salt_len,
+    int iterations,
+    size_t derived_key_len,        /* up to 64 bytes */
+    WCDeriveCallback callback,
+    void *user_data
+);
+
+/* * Deterministic IV mode.
+ * Every encrypt call drawing its 96-bit IV from RAND_bytes pays the
+ * global RAND lock and entropy mixing — measurable at small-message
+ * rates and serializing across worker threads. This mode switches the
+ * context to the SP 800-38D deterministic construction: a random
+ * 32-bit fixed field chosen once per context plus a 64-bit atomic
+ * invocation counter. IV generation becomes one fetch-add (no lock,
+ * no entropy pool), and uniqueness under the key is guaranteed rather
+ * than probabilistic. All encrypt paths on the context honor the mode
+ * (one-shot, iov, stream, bulk); decryption is unaffected since the IV
+ * travels with the ciphertext. */
+WCCryptoError wc_crypto_enable_deterministic_iv(WorkChainCryptoContext *ctx);
+
+/* * Random number generation.
+ * Backed by a per-thread entropy buffer: the thread refills a 4 KiB
+ * block from RAND_bytes and serves small requests from it locally, so
+ * concurrent callers stop contending on OpenSSL's RAND lock. Requests
+ * larger than the buffer go straight through. The buffer is wiped on
+ * thread exit. */
 WCCryptoError wc_random_bytes(unsigned char *buf, size_t buf_len);
 
 /* Constant-time comparison */
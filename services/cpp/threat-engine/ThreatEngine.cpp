@@ -6,9 +6,25 @@
 #include <map>
 #include <algorithm>
 #include <memory>
-#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <deque>
 #include <chrono>
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 namespace WorkChain::Security {
 
 /* ---------------------------------------------------------
@@ -16,9 +32,6 @@ namespace WorkChain::Security {
    Optimized: Uses shared_mutex for high-concurrency reading
 --------------------------------------------------------- */
 
-/* Mutex wrapper for Reader/Writer locks */
-static std::shared_mutex db_mutex;
-
 ThreatSignatureDatabase::ThreatSignatureDatabase() {
     /* Initialize with default threat signatures */
     addSignature({"rapid_failures", BehaviorPattern::RAPID_FAILURES, 5, 60000, ThreatLevel::MEDIUM, "5 failed requests in 1 minute"});
@@ -28,383 +41,2788 @@ ThreatSignatureDatabase::ThreatSignatureDatabase() {
     addSignature({"resource_abuse", BehaviorPattern::RESOURCE_ABUSE, 100, 60000, ThreatLevel::HIGH, "Excessive resource consumption"});
 }
 
+/* Rebuilds the flat compiled set from the staging map and publishes it.
+   Runs only on the write path; the swap is one atomic store. */
+void ThreatSignatureDatabase::recompile() {
+    auto set = std::make_shared<CompiledSet>();
+    set->by_id.reserve(signatures.size());
+    for (const auto& [id, sig] : signatures) {
+        set->by_id.push_back(sig);
+    }
+    std::sort(set->by_id.begin(), set->by_id.end(),
+        [](const ThreatSignature& a, const ThreatSignature& b) { return a.id < b.id; });
+
+    set->by_pattern = set->by_id;
+    std::stable_sort(set->by_pattern.begin(), set->by_pattern.end(),
+        [](const ThreatSignature& a, const ThreatSignature& b) { return a.pattern < b.pattern; });
+    for (uint32_t i = 0; i < set->by_pattern.size(); ) {
+        uint8_t p = static_cast<uint8_t>(set->by_pattern[i].pattern);
+        uint32_t start = i;
+        while (i < set->by_pattern.size() &&
+               static_cast<uint8_t>(set->by_pattern[i].pattern) == p) ++i;
+        if (p < set->pattern_index.size()) {
+            set->pattern_index[p] = { start, i - start };
+        }
+    }
+
+    std::atomic_store_explicit(&compiled, std::shared_ptr<const CompiledSet>(set),
+                               std::memory_order_release);
+}
+
 void ThreatSignatureDatabase::addSignature(const ThreatSignature& sig) {
     std::unique_lock<std::shared_mutex> lock(db_mutex); // Write lock
     signatures[sig.id] = sig;
+    recompile();
+}
+
+bool ThreatSignatureDatabase::loadFromFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::unordered_map<std::string, ThreatSignature> loaded;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream in(line);
+        ThreatSignature sig;
+        int pattern = 0, severity = 0;
+        if (!(in >> sig.id >> pattern >> sig.threshold >> sig.time_window_ms >> severity)) {
+            continue; // malformed line: skip rather than abort the load
+        }
+        sig.pattern = static_cast<BehaviorPattern>(pattern);
+        sig.severity = static_cast<ThreatLevel>(severity);
+        std::getline(in, sig.description);
+        if (!sig.description.empty() && sig.description[0] == ' ') {
+            sig.description.erase(0, 1);
+        }
+        loaded[sig.id] = sig;
+    }
+    if (loaded.empty()) return false;
+
+    std::unique_lock<std::shared_mutex> lock(db_mutex);
+    signatures = std::move(loaded);
+    recompile();
+    return true;
+}
+
+std::shared_ptr<const ThreatSignatureDatabase::CompiledSet> ThreatSignatureDatabase::snapshot() const {
+    return std::atomic_load_explicit(&compiled, std::memory_order_acquire);
 }
 
 const ThreatSignature* ThreatSignatureDatabase::getSignature(const std::string& id) const {
-    std::shared_lock<std::shared_mutex> lock(db_mutex); // Read lock (Allows multiple readers)
-    auto it = signatures.find(id);
-    return (it != signatures.end()) ? &it->second : nullptr;
+    auto set = snapshot();
+    if (!set) return nullptr;
+    /* Lock-free binary search over the sorted compiled array */
+    auto it = std::lower_bound(set->by_id.begin(), set->by_id.end(), id,
+        [](const ThreatSignature& sig, const std::string& key) { return sig.id < key; });
+    return (it != set->by_id.end() && it->id == id) ? &*it : nullptr;
 }
 
 bool ThreatSignatureDatabase::matchesPattern(BehaviorPattern pattern) const {
-    std::shared_lock<std::shared_mutex> lock(db_mutex); // Read lock
-    return std::any_of(signatures.begin(), signatures.end(),
-        [pattern](const auto& pair) { return pair.second.pattern == pattern; });
+    auto set = snapshot();
+    if (!set) return false;
+    /* O(1) index lookup regardless of signature count */
+    uint8_t p = static_cast<uint8_t>(pattern);
+    return p < set->pattern_index.size() && set->pattern_index[p].second > 0;
 }
 
 /* ---------------------------------------------------------
-   BehaviorAnalyzer Implementation
-   Optimized: Garbage collection for stale clients
+   SIMD score-kernel primitives
+   Runtime dispatch: AVX2 on x86-64 where available, NEON on
+   aarch64, scalar otherwise. The scalar bodies are also the
+   reference implementations.
 --------------------------------------------------------- */
 
-static std::shared_mutex history_mutex;
+namespace simd {
 
-BehaviorAnalyzer::BehaviorAnalyzer(size_t history_size) 
-    : max_history_size(history_size) {}
+[[maybe_unused]] static double sum_f32_scalar(const float* data, size_t n) {
+    double acc = 0.0;
+    for (size_t i = 0; i < n; ++i) acc += data[i];
+    return acc;
+}
 
-void BehaviorAnalyzer::recordBehavior(const BehaviorMetrics& metrics) {
-    std::unique_lock<std::shared_mutex> lock(history_mutex);
-    
-    // Auto-cleanup: Randomly check size to prevent DoS via memory exhaustion
-    if (history.size() > 10000) { 
-        cleanupStaleHistory(); 
-    }
+[[maybe_unused]] static double sumsq_f32_scalar(const float* data, size_t n) {
+    double acc = 0.0;
+    for (size_t i = 0; i < n; ++i) acc += (double)data[i] * data[i];
+    return acc;
+}
 
-    auto& client_hist = history[metrics.client_id];
-    
-    if (client_hist.behaviors.empty()) {
-        client_hist.first_seen = metrics.timestamp;
-    }
-    
-    client_hist.behaviors.push_back(metrics);
-    client_hist.last_seen = metrics.timestamp;
-    
-    /* Keep history size bounded (Sliding Window) */
-    if (client_hist.behaviors.size() > max_history_size) {
-        client_hist.behaviors.erase(client_hist.behaviors.begin());
-    }
+[[maybe_unused]] static size_t count_above_f32_scalar(const float* data, size_t n, float threshold) {
+    size_t c = 0;
+    for (size_t i = 0; i < n; ++i) c += (data[i] > threshold);
+    return c;
 }
 
-/* Helper to clean RAM from attackers generating random Client IDs */
-void BehaviorAnalyzer::cleanupStaleHistory() {
-    auto now = std::chrono::high_resolution_clock::now();
-    for (auto it = history.begin(); it != history.end(); ) {
-        auto idle_time = std::chrono::duration_cast<std::chrono::hours>(now - it->second.last_seen).count();
-        if (idle_time > 24) { // Remove clients idle for > 24h
-            it = history.erase(it);
-        } else {
-            ++it;
-        }
-    }
+[[maybe_unused]] static size_t count_ge_i64_scalar(const int64_t* data, size_t n, int64_t cutoff) {
+    size_t c = 0;
+    for (size_t i = 0; i < n; ++i) c += (data[i] >= cutoff);
+    return c;
 }
 
-AnomalyScore BehaviorAnalyzer::analyzeBehavior(const std::string& client_id) {
-    /* Critical: We lock ONCE for reading to ensure data consistency between Score and Patterns */
-    std::shared_lock<std::shared_mutex> lock(history_mutex);
+#if defined(__x86_64__)
+
+static bool haveAvx2() {
+    static const bool available = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return available;
+}
 
-    auto it = history.find(client_id);
-    if (it == history.end() || it->second.behaviors.empty()) {
-        return { client_id, 0.0f, ThreatLevel::SAFE, {}, std::chrono::high_resolution_clock::now() };
+__attribute__((target("avx2")))
+static double sum_f32_avx2(const float* data, size_t n) {
+    __m256d acc = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(data + i);
+        /* widen to double before accumulating to keep 10k-element sums exact */
+        acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+        acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
     }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    double total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; ++i) total += data[i];
+    return total;
+}
 
-    const auto& client_hist = it->second;
+__attribute__((target("avx2,fma")))
+static double sumsq_f32_avx2(const float* data, size_t n) {
+    __m256d acc = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(data + i);
+        __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(v));
+        __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1));
+        acc = _mm256_fmadd_pd(lo, lo, acc);
+        acc = _mm256_fmadd_pd(hi, hi, acc);
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    double total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; ++i) total += (double)data[i] * data[i];
+    return total;
+}
 
-    // Calculate internals without re-locking
-    float total_score = 0.0f;
-    total_score += calculateRapidFailureScore(client_hist) * 0.25f;
-    total_score += calculateEnumerationScore(client_hist) * 0.25f;
-    total_score += calculatePayloadScore(client_hist) * 0.30f;
-    total_score += calculateTimingScore(client_hist) * 0.10f;
-    total_score += calculateResourceScore(client_hist) * 0.10f;
-    
-    float final_score = std::min(total_score, 1.0f);
-
-    std::vector<BehaviorPattern> patterns;
-    if (calculateRapidFailureScore(client_hist) > 0.7f) patterns.push_back(BehaviorPattern::RAPID_FAILURES);
-    if (calculateEnumerationScore(client_hist) > 0.7f) patterns.push_back(BehaviorPattern::ENUMERATION);
-    if (calculatePayloadScore(client_hist) > 0.7f) patterns.push_back(BehaviorPattern::PAYLOAD_INJECTION);
-    if (calculateTimingScore(client_hist) > 0.7f) patterns.push_back(BehaviorPattern::TIMING_ATTACK);
-    if (calculateResourceScore(client_hist) > 0.7f) patterns.push_back(BehaviorPattern::RESOURCE_ABUSE);
-
-    ThreatLevel level = ThreatLevel::SAFE;
-    if (final_score > 0.9f) level = ThreatLevel::CRITICAL;
-    else if (final_score > 0.75f) level = ThreatLevel::HIGH;
-    else if (final_score > 0.5f) level = ThreatLevel::MEDIUM;
-    else if (final_score > 0.25f) level = ThreatLevel::LOW;
-    
-    return {
-        client_id,
-        final_score,
-        level,
-        patterns,
-        std::chrono::high_resolution_clock::now()
-    };
+__attribute__((target("avx2")))
+static size_t count_above_f32_avx2(const float* data, size_t n, float threshold) {
+    __m256 thr = _mm256_set1_ps(threshold);
+    size_t count = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(data + i);
+        __m256 gt = _mm256_cmp_ps(v, thr, _CMP_GT_OQ);
+        count += (size_t)__builtin_popcount(_mm256_movemask_ps(gt));
+    }
+    for (; i < n; ++i) count += (data[i] > threshold);
+    return count;
 }
 
-/* Note: These internal calculation functions assume the caller holds the lock */
-float BehaviorAnalyzer::calculateRapidFailureScore(const ClientHistory& history) {
-    if (history.behaviors.size() < 3) return 0.0f;
-    auto now = std::chrono::high_resolution_clock::now();
-    uint32_t failures = 0;
-    
-    for (auto it = history.behaviors.rbegin(); it != history.behaviors.rend(); ++it) {
-         auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - it->timestamp).count();
-         if (elapsed > 60000) break; // Optimization: Stop checking if older than window
-         
-         // Assuming 'confidence' maps to success/fail logic (e.g. low confidence = fail)
-         // Or strictly checking a status flag if added to metrics
-         if (it->confidence > 0.8f) failures++; // Adjusted logic based on context
+__attribute__((target("avx2")))
+static size_t count_ge_i64_avx2(const int64_t* data, size_t n, int64_t cutoff) {
+    /* a >= b  ==  !(b > a) */
+    __m256i cut = _mm256_set1_epi64x(cutoff);
+    size_t count = 0, i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i lt = _mm256_cmpgt_epi64(cut, v);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(lt));
+        count += 4 - (size_t)__builtin_popcount(mask);
     }
-    return std::min(failures / 5.0f, 1.0f);
+    for (; i < n; ++i) count += (data[i] >= cutoff);
+    return count;
 }
 
-float BehaviorAnalyzer::calculateEnumerationScore(const ClientHistory& history) {
-    if (history.behaviors.size() < 5) return 0.0f;
-    std::map<std::string, uint32_t> path_counts;
-    for (const auto& behavior : history.behaviors) {
-        if (!behavior.resource_id.empty()) {
-            path_counts[behavior.resource_id]++;
-        }
+double sum_f32(const float* data, size_t n) {
+    return haveAvx2() ? sum_f32_avx2(data, n) : sum_f32_scalar(data, n);
+}
+double sumsq_f32(const float* data, size_t n) {
+    return haveAvx2() ? sumsq_f32_avx2(data, n) : sumsq_f32_scalar(data, n);
+}
+size_t count_above_f32(const float* data, size_t n, float threshold) {
+    return haveAvx2() ? count_above_f32_avx2(data, n, threshold) : count_above_f32_scalar(data, n, threshold);
+}
+size_t count_ge_i64(const int64_t* data, size_t n, int64_t cutoff) {
+    return haveAvx2() ? count_ge_i64_avx2(data, n, cutoff) : count_ge_i64_scalar(data, n, cutoff);
+}
+
+#elif defined(__aarch64__)
+
+double sum_f32(const float* data, size_t n) {
+    float64x2_t acc = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vld1q_f32(data + i);
+        acc = vaddq_f64(acc, vcvt_f64_f32(vget_low_f32(v)));
+        acc = vaddq_f64(acc, vcvt_f64_f32(vget_high_f32(v)));
     }
-    // High unique paths count = Enumeration scanning
-    uint32_t unique_paths = path_counts.size();
-    return std::min(unique_paths / 20.0f, 1.0f);
+    double total = vaddvq_f64(acc);
+    for (; i < n; ++i) total += data[i];
+    return total;
 }
 
-float BehaviorAnalyzer::calculatePayloadScore(const ClientHistory& history) {
-    uint32_t suspicious_payloads = 0;
-    for (const auto& behavior : history.behaviors) {
-        if (behavior.pattern == BehaviorPattern::PAYLOAD_INJECTION) suspicious_payloads++;
+double sumsq_f32(const float* data, size_t n) {
+    float64x2_t acc = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vld1q_f32(data + i);
+        float64x2_t lo = vcvt_f64_f32(vget_low_f32(v));
+        float64x2_t hi = vcvt_f64_f32(vget_high_f32(v));
+        acc = vfmaq_f64(acc, lo, lo);
+        acc = vfmaq_f64(acc, hi, hi);
     }
-    return suspicious_payloads > 0 ? 1.0f : 0.0f;
+    double total = vaddvq_f64(acc);
+    for (; i < n; ++i) total += (double)data[i] * data[i];
+    return total;
 }
 
-float BehaviorAnalyzer::calculateTimingScore(const ClientHistory& history) {
-    if (history.behaviors.size() < 10) return 0.0f;
-    std::vector<long long> intervals;
-    for (size_t i = 1; i < history.behaviors.size(); ++i) {
-        auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(
-            history.behaviors[i].timestamp - history.behaviors[i-1].timestamp
-        ).count();
-        intervals.push_back(delta);
+size_t count_above_f32(const float* data, size_t n, float threshold) {
+    float32x4_t thr = vdupq_n_f32(threshold);
+    uint32x4_t ones = vdupq_n_u32(1);
+    uint32x4_t acc = vdupq_n_u32(0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        uint32x4_t gt = vcgtq_f32(vld1q_f32(data + i), thr);
+        acc = vaddq_u32(acc, vandq_u32(gt, ones));
     }
-    
-    double mean = std::accumulate(intervals.begin(), intervals.end(), 0.0) / intervals.size();
-    double variance = 0.0;
-    for (auto interval : intervals) variance += (interval - mean) * (interval - mean);
-    variance /= intervals.size();
-    double std_dev = std::sqrt(variance);
-    
-    // Very low jitter (StdDev < 10ms) implies bot automation
-    return std_dev < 10.0 ? 0.9f : 0.0f;
+    size_t count = vaddvq_u32(acc);
+    for (; i < n; ++i) count += (data[i] > threshold);
+    return count;
 }
 
-float BehaviorAnalyzer::calculateResourceScore(const ClientHistory& history) {
-    if (history.behaviors.size() < 5) return 0.0f;
-    uint32_t high_resource_requests = 0;
-    for (const auto& behavior : history.behaviors) {
-        // Safe map lookup
-        auto it = behavior.indicators.find("resource_usage");
-        if (it != behavior.indicators.end() && it->second > 0.8) {
-            high_resource_requests++;
-        }
+size_t count_ge_i64(const int64_t* data, size_t n, int64_t cutoff) {
+    int64x2_t cut = vdupq_n_s64(cutoff);
+    uint64x2_t ones = vdupq_n_u64(1);
+    uint64x2_t acc = vdupq_n_u64(0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        uint64x2_t ge = vcgeq_s64(vld1q_s64(data + i), cut);
+        acc = vaddq_u64(acc, vandq_u64(ge, ones));
     }
-    return std::min(high_resource_requests / 10.0f, 1.0f);
+    size_t count = vaddvq_u64(acc);
+    for (; i < n; ++i) count += (data[i] >= cutoff);
+    return count;
 }
 
-// These dummy implementations were missing in public API but needed for compilation
-float BehaviorAnalyzer::calculateAnomalyScore(const std::string& client_id) {
-    // Redirects to main logic to avoid code duplication
-    return analyzeBehavior(client_id).score;
+#else
+
+double sum_f32(const float* data, size_t n) { return sum_f32_scalar(data, n); }
+double sumsq_f32(const float* data, size_t n) { return sumsq_f32_scalar(data, n); }
+size_t count_above_f32(const float* data, size_t n, float threshold) { return count_above_f32_scalar(data, n, threshold); }
+size_t count_ge_i64(const int64_t* data, size_t n, int64_t cutoff) { return count_ge_i64_scalar(data, n, cutoff); }
+
+#endif
+
+} // namespace simd
+
+/* ---------------------------------------------------------
+   CoarseClock Implementation
+--------------------------------------------------------- */
+
+CoarseClock& CoarseClock::instance() {
+    static CoarseClock clock;
+    return clock;
 }
-std::vector<BehaviorPattern> BehaviorAnalyzer::detectPatterns(const std::string& client_id) {
-    return analyzeBehavior(client_id).detected_patterns;
+
+CoarseClock::CoarseClock() {
+    now_ns.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                 std::memory_order_relaxed);
+    ticker_thread = std::thread(&CoarseClock::tickerLoop, this);
+}
+
+CoarseClock::~CoarseClock() {
+    ticker_stop = true;
+    if (ticker_thread.joinable()) ticker_thread.join();
+}
+
+TimePoint CoarseClock::now() const {
+    int64_t ns = now_ns.load(std::memory_order_relaxed);
+    if (ns == 0) { // not yet ticked (static init order): read the real clock
+        return std::chrono::steady_clock::now();
+    }
+    return TimePoint(std::chrono::steady_clock::duration(ns));
+}
+
+void CoarseClock::tickerLoop() {
+    while (!ticker_stop.load(std::memory_order_relaxed)) {
+        now_ns.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                     std::memory_order_relaxed);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
 }
 
 /* ---------------------------------------------------------
-   AdaptiveThresholdManager Implementation
+   StringInterner Implementation
 --------------------------------------------------------- */
 
-static std::mutex threshold_mutex; // Config changes are rare, standard mutex is fine
+StringInterner::StringInterner() {
+    /* Handle 0 is the empty string so "no resource" is a zero handle */
+    strings.push_back("");
+    handles_by_hash.emplace(std::hash<std::string_view>{}(std::string_view{}), 0);
+}
 
-AdaptiveThresholdManager::AdaptiveThresholdManager() {
-    thresholds["rate_limit"] = 100.0f;
-    thresholds["anomaly_score"] = 0.5f;
-    thresholds["failure_count"] = 5.0f;
-    thresholds["enumeration_attempts"] = 20.0f;
+uint32_t StringInterner::intern(std::string_view s) {
+    uint64_t h = std::hash<std::string_view>{}(s);
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto [it, end] = handles_by_hash.equal_range(h);
+        for (; it != end; ++it) {
+            if (strings[it->second] == s) return it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto [it, end] = handles_by_hash.equal_range(h); // re-check under the write lock
+    for (; it != end; ++it) {
+        if (strings[it->second] == s) return it->second;
+    }
+    uint32_t handle = (uint32_t)strings.size();
+    strings.emplace_back(s); // the one and only copy of this string
+    handles_by_hash.emplace(h, handle);
+    return handle;
 }
 
-void AdaptiveThresholdManager::updateThreshold(const std::string& metric, float new_threshold) {
-    std::lock_guard<std::mutex> lock(threshold_mutex);
-    thresholds[metric] = new_threshold;
+const std::string& StringInterner::lookup(uint32_t handle) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (handle >= strings.size()) return strings[0];
+    return strings[handle];
 }
 
-float AdaptiveThresholdManager::getThreshold(const std::string& metric) const {
-    std::lock_guard<std::mutex> lock(threshold_mutex);
-    auto it = thresholds.find(metric);
-    return (it != thresholds.end()) ? it->second : 0.5f;
+uint32_t StringInterner::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return (uint32_t)strings.size();
 }
 
-void AdaptiveThresholdManager::reinforceThresholds(const AnomalyScore& anomaly) {
-    std::lock_guard<std::mutex> lock(threshold_mutex);
-    hit_counts[std::to_string(static_cast<int>(anomaly.level))]++;
-    
-    /* Harden thresholds dynamically under attack */
-    if (anomaly.level >= ThreatLevel::HIGH) {
-        thresholds["rate_limit"] = std::max(10.0f, thresholds["rate_limit"] * 0.9f); // Never go below 10
-        thresholds["anomaly_score"] = std::max(0.2f, thresholds["anomaly_score"] * 0.95f);
-    }
+StringInterner& globalInterner() {
+    static StringInterner interner;
+    return interner;
 }
 
-void AdaptiveThresholdManager::resetThresholds() {
-    std::lock_guard<std::mutex> lock(threshold_mutex);
-    thresholds.clear();
-    hit_counts.clear();
-    // Restore defaults
-    thresholds["rate_limit"] = 100.0f;
+IndicatorKey indicatorKeyFromName(const std::string& name) {
+    if (name == "resource_usage") return IndicatorKey::RESOURCE_USAGE;
+    if (name == "request_size") return IndicatorKey::REQUEST_SIZE;
+    if (name == "response_time_ms") return IndicatorKey::RESPONSE_TIME_MS;
+    if (name == "failure_flag") return IndicatorKey::FAILURE_FLAG;
+    return IndicatorKey::COUNT;
 }
 
 /* ---------------------------------------------------------
-   RateLimitingPolicy Implementation
+   Snapshot serialization helpers
+   Little-endian, memcpy-based; the Reader bounds-checks every field so a
+   truncated or corrupt snapshot fails restore instead of walking off the
+   mapping.
 --------------------------------------------------------- */
 
-static std::mutex policy_mutex; // Ideally shared_mutex, but writes are frequent (every request)
+namespace {
 
-RateLimitingPolicy::RateLimitingPolicy(uint32_t default_rps) 
-    : default_rps(default_rps) {}
+struct SnapshotWriter {
+    std::vector<uint8_t>& out;
 
-bool RateLimitingPolicy::checkLimit(const std::string& client_id) {
-    std::lock_guard<std::mutex> lock(policy_mutex);
-    
-    auto& policy = policies[client_id];
-    auto now = std::chrono::high_resolution_clock::now();
-    
-    // Initialize defaults if new client
-    if (policy.requests_per_second == 0) policy.requests_per_second = default_rps;
+    void bytes(const void* p, size_t n) {
+        const uint8_t* b = (const uint8_t*)p;
+        out.insert(out.end(), b, b + n);
+    }
+    void u8(uint8_t v)   { bytes(&v, sizeof(v)); }
+    void u32(uint32_t v) { bytes(&v, sizeof(v)); }
+    void u64(uint64_t v) { bytes(&v, sizeof(v)); }
+    void i64(int64_t v)  { bytes(&v, sizeof(v)); }
+    void f32(float v)    { bytes(&v, sizeof(v)); }
+    void str(const std::string& v) {
+        u32((uint32_t)v.size());
+        bytes(v.data(), v.size());
+    }
+};
 
-    if (std::chrono::duration_cast<std::chrono::seconds>(now - policy.last_reset).count() >= 1) {
-        policy.request_count = 0;
-        policy.last_reset = now;
+struct SnapshotReader {
+    const uint8_t* p;
+    size_t left;
+
+    bool bytes(void* dst, size_t n) {
+        if (n > left) return false;
+        std::memcpy(dst, p, n);
+        p += n;
+        left -= n;
+        return true;
     }
-    
-    if (policy.request_count >= policy.requests_per_second) {
-        return false; // LIMIT EXCEEDED
+    bool u8(uint8_t& v)   { return bytes(&v, sizeof(v)); }
+    bool u32(uint32_t& v) { return bytes(&v, sizeof(v)); }
+    bool u64(uint64_t& v) { return bytes(&v, sizeof(v)); }
+    bool i64(int64_t& v)  { return bytes(&v, sizeof(v)); }
+    bool f32(float& v)    { return bytes(&v, sizeof(v)); }
+    bool str(std::string& v) {
+        uint32_t n;
+        if (!u32(n) || n > left) return false;
+        v.assign((const char*)p, n);
+        p += n;
+        left -= n;
+        return true;
     }
-    
-    policy.request_count++;
-    return true; // ALLOWED
+};
+
+} // namespace
+
+/* ---------------------------------------------------------
+   BehaviorAnalyzer Implementation
+   Optimized: Lock-striped shards + SoA history + garbage collection
+--------------------------------------------------------- */
+
+size_t roundUpToPowerOfTwo(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
 }
 
-void RateLimitingPolicy::enforceDynamicLimits(const AnomalyScore& anomaly) {
-    std::lock_guard<std::mutex> lock(policy_mutex);
-    auto& policy = policies[anomaly.client_id];
-    
-    if (anomaly.level >= ThreatLevel::HIGH) {
-        policy.requests_per_second = std::max(1u, default_rps / 10);
-    } else if (anomaly.level >= ThreatLevel::MEDIUM) {
-        policy.requests_per_second = std::max(5u, default_rps / 5);
+BehaviorAnalyzer::BehaviorAnalyzer(size_t history_size, size_t shard_count)
+    : max_history_size(history_size) {
+    size_t count = roundUpToPowerOfTwo(std::max<size_t>(1, shard_count));
+    shard_mask = count - 1;
+    shards.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        shards.push_back(std::make_unique<HistoryShard>());
     }
+    sweep_cursors.assign(count, 0);
+    reaper_thread = std::thread(&BehaviorAnalyzer::reaperLoop, this);
 }
 
-void RateLimitingPolicy::resetPolicies() {
-    std::lock_guard<std::mutex> lock(policy_mutex);
-    policies.clear();
+BehaviorAnalyzer::~BehaviorAnalyzer() {
+    {
+        std::lock_guard<std::mutex> lock(reaper_mutex);
+        reaper_stop = true;
+    }
+    reaper_cv.notify_all();
+    if (reaper_thread.joinable()) reaper_thread.join();
+    if (cold_fd >= 0) close(cold_fd);
 }
 
-/* ---------------------------------------------------------
-   ThreatResponseEngine Implementation
---------------------------------------------------------- */
+void BehaviorAnalyzer::configureMaintenance(const MaintenanceConfig& config) {
+    std::lock_guard<std::mutex> lock(reaper_mutex);
+    maintenance = config;
+}
 
-static std::mutex response_mutex;
+void BehaviorAnalyzer::reaperLoop() {
+    for (;;) {
+        std::chrono::milliseconds interval;
+        {
+            std::unique_lock<std::mutex> lock(reaper_mutex);
+            interval = maintenance.sweep_interval;
+            if (reaper_cv.wait_for(lock, interval, [this] { return reaper_stop.load(); })) {
+                return;
+            }
+        }
+        reaperStep(sweep_shard);
+        sweep_shard = (sweep_shard + 1) & shard_mask;
+    }
+}
 
-ThreatResponseEngine::ThreatResponseEngine() {}
+/* One bounded sweep step: examine at most max_buckets_per_step buckets of
+   one shard, expiring idle clients. The bucket cursor persists across
+   steps, so the whole map is eventually covered without any single step
+   holding the write lock for long. Under memory pressure (shard over its
+   client budget) we fall back to a full sweep of that shard. */
+void BehaviorAnalyzer::reaperStep(size_t shard_index) {
+    MaintenanceConfig config;
+    {
+        std::lock_guard<std::mutex> lock(reaper_mutex);
+        config = maintenance;
+    }
 
-void ThreatResponseEngine::respondToThreat(const AnomalyScore& anomaly) {
-    if (anomaly.level >= ThreatLevel::CRITICAL) {
-        isolateClient(anomaly.client_id, anomaly.level);
-    } else if (anomaly.level >= ThreatLevel::HIGH) {
-        throttleClient(anomaly.client_id, 0.5f);
-        generateAlert(anomaly);
+    auto& shard = *shards[shard_index];
+    auto now = engineNow();
+    bool tiered = tiered_enabled.load(std::memory_order_relaxed);
+
+    /* Serialized cold records leave the lock scope with us, so the file
+       append happens without any shard lock held */
+    std::vector<std::pair<std::string, std::vector<uint8_t>>> demoted;
+
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+        if (shard.history.size() > config.max_clients_per_shard) {
+            cleanupStaleHistory(shard);
+            sweep_cursors[shard_index] = 0;
+            return;
+        }
+
+        size_t bucket_count = shard.history.bucket_count();
+        if (bucket_count == 0) return;
+
+        size_t cursor = sweep_cursors[shard_index] % bucket_count;
+        size_t examined = 0;
+        std::vector<std::string> expired;
+        std::vector<std::string> to_demote;
+
+        while (examined < config.max_buckets_per_step) {
+            for (auto it = shard.history.begin(cursor); it != shard.history.end(cursor); ++it) {
+                auto idle = now - it->second.last_seen;
+                if (idle > config.idle_ttl) {
+                    expired.push_back(it->first);
+                } else if (tiered && idle > tiered_idle && !it->second.empty()) {
+                    to_demote.push_back(it->first);
+                }
+            }
+            ++examined;
+            cursor = (cursor + 1) % bucket_count;
+            if (cursor == sweep_cursors[shard_index] % bucket_count) break; // full lap
+        }
+        sweep_cursors[shard_index] = cursor;
+
+        for (const auto& key : expired) {
+            shard.history.erase(key);
+        }
+        for (const auto& key : to_demote) {
+            auto it = shard.history.find(key);
+            if (it == shard.history.end()) continue;
+            std::vector<uint8_t> record;
+            serializeHistoryForCold(it->second, record);
+            demoted.emplace_back(key, std::move(record));
+            shard.history.erase(it);
+        }
+    }
+
+    for (auto& [key, record] : demoted) {
+        appendToCold(key, std::move(record));
     }
 }
 
-void ThreatResponseEngine::isolateClient(const std::string& client_id, ThreatLevel level) {
-    std::lock_guard<std::mutex> lock(response_mutex);
-    isolated_clients.push_back({
-        client_id,
-        level,
-        std::chrono::high_resolution_clock::now(),
-        "Threat level exceeded CRITICAL threshold - ISOLATION ENFORCED"
-    });
-    std::cout << "[SECURITY-ALERT] Client " << client_id << " ISOLATED due to CRITICAL THREAT." << std::endl;
+/* ---------------------------------------------------------
+   Cold tier: append-only segment for idle client histories
+--------------------------------------------------------- */
+
+bool BehaviorAnalyzer::enableTieredStorage(const std::string& segment_path,
+                                           std::chrono::minutes idle_threshold) {
+    std::lock_guard<std::mutex> lock(cold_mutex);
+    if (cold_fd >= 0) close(cold_fd);
+
+    /* Records hold raw monotonic timestamps, valid for this process run
+       only — start the segment fresh (restarts restore via snapshot) */
+    cold_fd = open(segment_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (cold_fd < 0) return false;
+
+    cold_file_size = 0;
+    cold_index.clear();
+    tiered_idle = idle_threshold;
+    tiered_enabled = true;
+    return true;
 }
 
-void ThreatResponseEngine::throttleClient(const std::string& client_id, float reduction_factor) {
-    // Integration point with Load Balancer or Reverse Proxy
-    std::cout << "[SECURITY-INFO] Throttling client " << client_id << " by factor " << reduction_factor << std::endl;
+size_t BehaviorAnalyzer::coldClientCount() const {
+    std::lock_guard<std::mutex> lock(cold_mutex);
+    return cold_index.size();
 }
 
-void ThreatResponseEngine::rerouteTraffic(const std::string& client_id) {
-    // Honeypot redirection logic would go here
+/* Flat record mirroring the snapshot layout, but with raw monotonic
+   nanoseconds instead of re-based ages (the segment never crosses a
+   process boundary) and raw interner handles (stable for the process
+   lifetime). Aggregates and the failure prefix stay derived state. */
+void BehaviorAnalyzer::serializeHistoryForCold(const ClientHistory& hist,
+                                               std::vector<uint8_t>& out) const {
+    SnapshotWriter w{out};
+    w.u32((uint32_t)hist.timestamps.capacity());
+    w.u32((uint32_t)hist.size());
+    w.u32(hist.client_handle);
+    w.i64(hist.first_seen.time_since_epoch().count());
+    w.i64(hist.last_seen.time_since_epoch().count());
+
+    for (size_t i = 0; i < hist.size(); ++i) w.i64(hist.timestamps[i].time_since_epoch().count());
+    for (size_t i = 0; i < hist.size(); ++i) w.u8(hist.patterns[i]);
+    for (size_t i = 0; i < hist.size(); ++i) w.f32(hist.confidences[i]);
+    for (size_t i = 0; i < hist.size(); ++i) w.u32(hist.resources[i]);
+    for (size_t k = 0; k < kIndicatorKeyCount; ++k) {
+        for (size_t i = 0; i < hist.size(); ++i) w.f32(hist.indicators[k][i]);
+    }
 }
 
-void ThreatResponseEngine::generateAlert(const AnomalyScore& anomaly) {
-    // Integration with SIEM / Dashboard
-    std::cout << "[SECURITY-WARN] Anomaly detected for " << anomaly.client_id << ". Score: " << anomaly.score << std::endl;
+void BehaviorAnalyzer::appendToCold(const std::string& client_id,
+                                    std::vector<uint8_t>&& record) {
+    std::lock_guard<std::mutex> lock(cold_mutex);
+    if (cold_fd < 0) return;
+
+    size_t written = 0;
+    while (written < record.size()) {
+        ssize_t n = pwrite(cold_fd, record.data() + written, record.size() - written,
+                           (off_t)(cold_file_size + written));
+        if (n <= 0) return; // segment full/unwritable: history is simply dropped
+        written += (size_t)n;
+    }
+
+    /* Latest record wins; superseded extents stay in the segment as
+       append-only garbage until the next process start */
+    cold_index[client_id] = ColdRecordRef{cold_file_size, record.size()};
+    cold_file_size += record.size();
 }
 
-/* ---------------------------------------------------------
-   NanoSecurityMesh Implementation
-   The Main Entry Point
---------------------------------------------------------- */
+/* Maps the record's page range read-only, fills the rings, and rebuilds
+   the derived aggregates. Called with the client's shard write lock held
+   (fault-ins are rare — one per returning cold client — and the read is
+   normally served from page cache). */
+bool BehaviorAnalyzer::faultInFromCold(const std::string& client_id, ClientHistory& hist) {
+    ColdRecordRef ref;
+    {
+        std::lock_guard<std::mutex> lock(cold_mutex);
+        auto it = cold_index.find(client_id);
+        if (it == cold_index.end()) return false;
+        ref = it->second;
+        cold_index.erase(it); // resident again; re-demotion re-appends
+    }
 
-static std::mutex mesh_mutex;
+    long page = sysconf(_SC_PAGESIZE);
+    uint64_t map_off = ref.offset & ~((uint64_t)page - 1);
+    size_t delta = (size_t)(ref.offset - map_off);
+    size_t map_len = ref.length + delta;
 
-NanoSecurityMesh::NanoSecurityMesh() : initialized(false) {
-    signature_db = std::make_unique<ThreatSignatureDatabase>();
-    behavior_analyzer = std::make_unique<BehaviorAnalyzer>();
-    threshold_manager = std::make_unique<AdaptiveThresholdManager>();
-    rate_limiter = std::make_unique<RateLimitingPolicy>();
-    response_engine = std::make_unique<ThreatResponseEngine>();
+    void* mapped = mmap(nullptr, map_len, PROT_READ, MAP_PRIVATE, cold_fd, (off_t)map_off);
+    if (mapped == MAP_FAILED) return false;
+
+    SnapshotReader r{(const uint8_t*)mapped + delta, ref.length};
+    bool ok = false;
+
+    uint32_t capacity, n, client_handle;
+    int64_t first_ns, last_ns;
+    if (r.u32(capacity) && r.u32(n) && r.u32(client_handle) &&
+        r.i64(first_ns) && r.i64(last_ns) && n <= capacity && capacity <= (1u << 24)) {
+        hist.setCapacity(std::max<size_t>(capacity, max_history_size));
+        hist.client_handle = client_handle;
+        hist.first_seen = TimePoint(TimePoint::duration(first_ns));
+        hist.last_seen = TimePoint(TimePoint::duration(last_ns));
+
+        ok = true;
+        for (uint32_t i = 0; ok && i < n; ++i) {
+            int64_t ts;
+            ok = r.i64(ts);
+            if (ok) hist.timestamps.push(TimePoint(TimePoint::duration(ts)));
+        }
+        for (uint32_t i = 0; ok && i < n; ++i) {
+            uint8_t pat;
+            ok = r.u8(pat);
+            if (ok) hist.patterns.push(pat);
+        }
+        for (uint32_t i = 0; ok && i < n; ++i) {
+            float conf;
+            ok = r.f32(conf);
+            if (ok) hist.confidences.push(conf);
+        }
+        for (uint32_t i = 0; ok && i < n; ++i) {
+            uint32_t res;
+            ok = r.u32(res);
+            if (ok) hist.resources.push(res);
+        }
+        for (size_t k = 0; ok && k < kIndicatorKeyCount; ++k) {
+            for (uint32_t i = 0; ok && i < n; ++i) {
+                float v;
+                ok = r.f32(v);
+                if (ok) hist.indicators[k].push(v);
+            }
+        }
+    }
+
+    munmap(mapped, map_len);
+
+    if (!ok) {
+        hist = ClientHistory{}; // corrupt record: start the client fresh
+        return false;
+    }
+
+    hist.recomputeAggregates();
+    return true;
 }
 
-NanoSecurityMesh::~NanoSecurityMesh() = default;
+void BehaviorAnalyzer::ClientHistory::setCapacity(size_t capacity) {
+    timestamps.setCapacity(capacity);
+    patterns.setCapacity(capacity);
+    confidences.setCapacity(capacity);
+    resources.setCapacity(capacity);
+    for (auto& ring : indicators) ring.setCapacity(capacity);
+    failure_prefix.setCapacity(capacity);
+}
 
-void NanoSecurityMesh::initialize() {
-    std::lock_guard<std::mutex> lock(mesh_mutex);
-    initialized = true;
+/* Removes the oldest entry's contribution from the running aggregates.
+   Called right before the ring overwrites it. */
+void BehaviorAnalyzer::ClientHistory::evictOldest() {
+    if (patterns[0] == static_cast<uint8_t>(BehaviorPattern::PAYLOAD_INJECTION)) {
+        agg.payload_count--;
+    }
+    if (indicators[static_cast<size_t>(IndicatorKey::RESOURCE_USAGE)][0] > 0.8f) {
+        agg.high_resource_count--;
+    }
+    uint32_t res = resources[0];
+    if (res != 0) {
+        auto it = agg.resource_counts.find(res);
+        if (it != agg.resource_counts.end() && --it->second == 0) {
+            agg.resource_counts.erase(it);
+        }
+    }
+    if (size() >= 2) {
+        double oldest_interval = (double)std::chrono::duration_cast<std::chrono::milliseconds>(
+            timestamps[1] - timestamps[0]).count();
+        agg.interval_sum -= oldest_interval;
+        agg.interval_sum_sq -= oldest_interval * oldest_interval;
+    }
 }
 
-/* FIXED: Returns 'bool' to enforce filtering.
-   Returns: true (ALLOW), false (BLOCK)
-*/
-bool NanoSecurityMesh::processRequest(const std::string& client_id, const BehaviorMetrics& metrics) {
-    if (!initialized) return true; // Fail open if not ready (or false depending on policy)
-    
-    // 1. Rate Limit Check (First line of defense)
-    if (!rate_limiter->checkLimit(client_id)) {
-        return false; // BLOCK: Rate limit exceeded
+/* Legacy entry point: flattens the indicators map onto the fixed key
+   array, then reduces to the field-wise append. */
+void BehaviorAnalyzer::ClientHistory::append(const BehaviorMetrics& metrics, uint32_t resource_handle) {
+    std::array<float, kIndicatorKeyCount> values{};
+    for (const auto& [name, value] : metrics.indicators) {
+        IndicatorKey key = indicatorKeyFromName(name);
+        if (key != IndicatorKey::COUNT) {
+            values[static_cast<size_t>(key)] = (float)value;
+        }
     }
+    append(metrics.timestamp, metrics.pattern, metrics.confidence, resource_handle, values);
+}
 
-    // 2. Behavior Analysis
-    behavior_analyzer->recordBehavior(metrics);
-    auto anomaly = behavior_analyzer->analyzeBehavior(client_id);
-    
-    // 3. Dynamic Response
-    if (anomaly.level >= ThreatLevel::MEDIUM) {
-        threshold_manager->reinforceThresholds(anomaly);
-        rate_limiter->enforceDynamicLimits(anomaly);
-        response_engine->respondToThreat(anomaly);
+/* Appends one observation across the parallel field rings, updating the
+   running aggregates in O(1). The caller interns the resource ID so the
+   string table lock is not taken while holding the shard lock. */
+void BehaviorAnalyzer::ClientHistory::append(TimePoint timestamp, BehaviorPattern pattern,
+                                             float confidence, uint32_t resource_handle,
+                                             const std::array<float, kIndicatorKeyCount>& values) {
+    if (timestamps.size() == timestamps.capacity()) {
+        evictOldest();
     }
 
-    // 4. FILTERING DECISION (The missing piece in your original code)
-    if (anomaly.level >= ThreatLevel::CRITICAL) {
-        return false; // BLOCK: High Threat
+    if (!timestamps.empty()) {
+        double interval = (double)std::chrono::duration_cast<std::chrono::milliseconds>(
+            timestamp - timestamps.back()).count();
+        agg.interval_sum += interval;
+        agg.interval_sum_sq += interval * interval;
     }
-    
-    // Check specific blocking signatures (like SQL Injection)
-    for (const auto& pattern : anomaly.detected_patterns) {
-        if (pattern == BehaviorPattern::PAYLOAD_INJECTION) return false;
+    if (pattern == BehaviorPattern::PAYLOAD_INJECTION) {
+        agg.payload_count++;
+    }
+    if (resource_handle != 0) {
+        agg.resource_counts[resource_handle]++;
     }
 
-    return true; // ALLOW
+    timestamps.push(timestamp);
+    patterns.push(static_cast<uint8_t>(pattern));
+    confidences.push(confidence);
+    resources.push(resource_handle);
+
+    uint64_t prev_failures = failure_prefix.empty() ? 0 : failure_prefix.back();
+    failure_prefix.push(prev_failures + (confidence > 0.8f ? 1 : 0));
+
+    if (values[static_cast<size_t>(IndicatorKey::RESOURCE_USAGE)] > 0.8f) {
+        agg.high_resource_count++;
+    }
+    for (size_t k = 0; k < kIndicatorKeyCount; ++k) {
+        indicators[k].push(values[k]);
+    }
+}
+
+/* Rebuilds the running aggregates from the raw field rings. Bulk-load
+   paths (snapshot restore, cold-client fault-in) fill the rings without
+   going through append(), so the O(1) maintenance never ran. The
+   predicate counts run through the SIMD kernels over the ring's
+   contiguous segments. */
+void BehaviorAnalyzer::ClientHistory::recomputeAggregates() {
+    agg = Aggregates{};
+
+    const auto& usage = indicators[static_cast<size_t>(IndicatorKey::RESOURCE_USAGE)];
+    const float* seg1 = nullptr; const float* seg2 = nullptr;
+    size_t len1 = 0, len2 = 0;
+    size_t nsegs = usage.segments(&seg1, &len1, &seg2, &len2);
+    if (nsegs >= 1) agg.high_resource_count += simd::count_above_f32(seg1, len1, 0.8f);
+    if (nsegs == 2) agg.high_resource_count += simd::count_above_f32(seg2, len2, 0.8f);
+
+    for (size_t i = 0; i < size(); ++i) {
+        if (patterns[i] == static_cast<uint8_t>(BehaviorPattern::PAYLOAD_INJECTION)) {
+            agg.payload_count++;
+        }
+        if (resources[i] != 0) {
+            agg.resource_counts[resources[i]]++;
+        }
+        if (i > 0) {
+            double interval = (double)std::chrono::duration_cast<std::chrono::milliseconds>(
+                timestamps[i] - timestamps[i-1]).count();
+            agg.interval_sum += interval;
+            agg.interval_sum_sq += interval * interval;
+        }
+    }
+
+    /* Rebuild the cumulative failure prefix in ring order */
+    failure_prefix.clear();
+    uint64_t cum = 0;
+    for (size_t i = 0; i < confidences.size(); ++i) {
+        cum += (confidences[i] > 0.8f) ? 1 : 0;
+        failure_prefix.push(cum);
+    }
+}
+
+uint64_t BehaviorAnalyzer::ClientHistory::failuresInWindow(TimePoint now, int64_t window_ms) const {
+    if (timestamps.empty()) return 0;
+    TimePoint cutoff = now - std::chrono::milliseconds(window_ms);
+
+    /* Binary search for the first entry inside the window (timestamps
+       are appended in arrival order, so the ring is sorted) */
+    size_t lo = 0, hi = timestamps.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (timestamps[mid] < cutoff) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == timestamps.size()) return 0; // everything is older than the window
+
+    uint64_t total = failure_prefix.back();
+    uint64_t before = (lo == 0)
+        ? failure_prefix[0] - (confidences[0] > 0.8f ? 1 : 0)
+        : failure_prefix[lo - 1];
+    return total - before;
+}
+
+void BehaviorAnalyzer::recordBehavior(const BehaviorMetrics& metrics) {
+    BehaviorSample sample;
+    sample.resource_id = metrics.resource_id;
+    sample.timestamp = metrics.timestamp;
+    sample.pattern = metrics.pattern;
+    sample.confidence = metrics.confidence;
+    for (const auto& [name, value] : metrics.indicators) {
+        IndicatorKey key = indicatorKeyFromName(name);
+        if (key != IndicatorKey::COUNT) {
+            sample.indicators[static_cast<size_t>(key)] = (float)value;
+        }
+    }
+    recordBehavior(metrics.client_id, sample);
+}
+
+void BehaviorAnalyzer::recordBehavior(const BehaviorRecord& record) {
+    BehaviorSample sample;
+    sample.resource_id = record.resource_id;
+    sample.timestamp = record.timestamp;
+    sample.pattern = record.pattern;
+    sample.confidence = record.confidence;
+    sample.indicators = record.indicators;
+    recordBehavior(record.client_id, sample);
+}
+
+void BehaviorAnalyzer::recordBehavior(const std::string& client_id, const BehaviorSample& sample) {
+    /* Intern outside the shard lock; views go straight into the table —
+       a known ID costs a hash probe, never an allocation */
+    uint32_t resource_handle = sample.resource_id.empty()
+        ? 0 : globalInterner().intern(sample.resource_id);
+    uint32_t client_handle = globalInterner().intern(client_id);
+
+    auto& shard = shardFor(client_id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+    /* No inline garbage collection here: expiry and memory-budget
+       enforcement run on the background reaper thread (reaperStep), so an
+       attack with randomized client IDs can no longer stall the request
+       path behind a full-map sweep */
+    auto& client_hist = shard.history[client_id];
+
+    /* Returning cold client: pull its demoted history off the disk
+       segment before recording, so the score kernels keep seeing the
+       long-horizon window */
+    if (client_hist.empty() && tiered_enabled.load(std::memory_order_relaxed)) {
+        faultInFromCold(client_id, client_hist);
+    }
+
+    if (client_hist.empty()) {
+        client_hist.first_seen = sample.timestamp;
+        client_hist.client_handle = client_handle;
+        if (client_hist.timestamps.capacity() == 0) {
+            client_hist.setCapacity(max_history_size);
+        }
+    }
+
+    /* O(1) append; the rings overwrite the oldest entry once full, so the
+       sliding window needs no erase and no element shifting */
+    client_hist.append(sample.timestamp, sample.pattern, sample.confidence,
+                       resource_handle, sample.indicators);
+    client_hist.last_seen = sample.timestamp;
+}
+
+/* Helper to clean RAM from attackers generating random Client IDs.
+   Operates on a single shard; caller holds that shard's write lock. */
+void BehaviorAnalyzer::cleanupStaleHistory(HistoryShard& shard) {
+    auto now = engineNow();
+    for (auto it = shard.history.begin(); it != shard.history.end(); ) {
+        auto idle_time = std::chrono::duration_cast<std::chrono::hours>(now - it->second.last_seen).count();
+        if (idle_time > 24) { // Remove clients idle for > 24h
+            it = shard.history.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/* Serializes every client history as a flat record: identity, ring
+   capacity, then the field arrays in logical (oldest-first) order.
+   Aggregates and the failure prefix are derived state and are not
+   written — restore rebuilds them with recomputeAggregates(). */
+void BehaviorAnalyzer::snapshotHistories(std::vector<uint8_t>& out, TimePoint now) const {
+    SnapshotWriter w{out};
+
+    size_t count_pos = out.size();
+    w.u64(0); // client count, patched below
+
+    uint64_t clients = 0;
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        for (const auto& [client_id, hist] : shard->history) {
+            if (hist.empty()) continue;
+
+            w.str(client_id);
+            w.u32((uint32_t)hist.timestamps.capacity());
+            w.u32((uint32_t)hist.size());
+            w.i64(std::chrono::duration_cast<std::chrono::milliseconds>(now - hist.first_seen).count());
+            w.i64(std::chrono::duration_cast<std::chrono::milliseconds>(now - hist.last_seen).count());
+
+            for (size_t i = 0; i < hist.size(); ++i) {
+                w.i64(std::chrono::duration_cast<std::chrono::milliseconds>(now - hist.timestamps[i]).count());
+            }
+            for (size_t i = 0; i < hist.size(); ++i) w.u8(hist.patterns[i]);
+            for (size_t i = 0; i < hist.size(); ++i) w.f32(hist.confidences[i]);
+            for (size_t i = 0; i < hist.size(); ++i) w.u32(hist.resources[i]);
+            for (size_t k = 0; k < kIndicatorKeyCount; ++k) {
+                for (size_t i = 0; i < hist.size(); ++i) w.f32(hist.indicators[k][i]);
+            }
+            ++clients;
+        }
+    }
+
+    std::memcpy(out.data() + count_pos, &clients, sizeof(clients));
+}
+
+bool BehaviorAnalyzer::restoreHistories(const uint8_t* data, size_t len,
+                                        const std::vector<uint32_t>& handle_remap,
+                                        TimePoint now) {
+    SnapshotReader r{data, len};
+
+    uint64_t clients;
+    if (!r.u64(clients)) return false;
+
+    for (uint64_t c = 0; c < clients; ++c) {
+        std::string client_id;
+        uint32_t capacity, n;
+        int64_t first_age, last_age;
+        if (!r.str(client_id) || !r.u32(capacity) || !r.u32(n) ||
+            !r.i64(first_age) || !r.i64(last_age) ||
+            client_id.empty() || n > capacity || capacity > (1u << 24)) {
+            return false;
+        }
+
+        ClientHistory hist;
+        hist.setCapacity(std::max<size_t>(capacity, max_history_size));
+        hist.client_handle = globalInterner().intern(client_id);
+        hist.first_seen = now - std::chrono::milliseconds(first_age);
+        hist.last_seen = now - std::chrono::milliseconds(last_age);
+
+        std::vector<int64_t> ages(n);
+        std::vector<uint8_t> pats(n);
+        std::vector<float> confs(n);
+        std::vector<uint32_t> res(n);
+        for (uint32_t i = 0; i < n; ++i) if (!r.i64(ages[i])) return false;
+        for (uint32_t i = 0; i < n; ++i) if (!r.u8(pats[i])) return false;
+        for (uint32_t i = 0; i < n; ++i) if (!r.f32(confs[i])) return false;
+        for (uint32_t i = 0; i < n; ++i) if (!r.u32(res[i])) return false;
+
+        for (uint32_t i = 0; i < n; ++i) {
+            hist.timestamps.push(now - std::chrono::milliseconds(ages[i]));
+            hist.patterns.push(pats[i]);
+            hist.confidences.push(confs[i]);
+            hist.resources.push(res[i] < handle_remap.size() ? handle_remap[res[i]] : 0);
+        }
+        for (size_t k = 0; k < kIndicatorKeyCount; ++k) {
+            for (uint32_t i = 0; i < n; ++i) {
+                float v;
+                if (!r.f32(v)) return false;
+                hist.indicators[k].push(v);
+            }
+        }
+
+        hist.recomputeAggregates();
+
+        auto& shard = shardFor(client_id);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.history[client_id] = std::move(hist);
+    }
+
+    return true;
+}
+
+AnomalyScore BehaviorAnalyzer::analyzeBehavior(const std::string& client_id) {
+    /* Feed the analyze-latency histogram on every exit path */
+    struct LatencyScope {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        ~LatencyScope() {
+            TelemetryHub::instance().recordAnalyzeLatency(
+                (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - begin).count());
+        }
+    } latency_scope;
+
+    /* Critical: We lock ONCE for reading to ensure data consistency between Score and Patterns.
+       Only this client's shard is locked; analysis of other clients proceeds in parallel. */
+    auto& shard = shardFor(client_id);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+    auto it = shard.history.find(client_id);
+    if (it == shard.history.end() || it->second.empty()) {
+        return { client_id, 0.0f, ThreatLevel::SAFE, {}, engineNow() };
+    }
+
+    return scoreClientLocked(client_id, it->second);
+}
+
+/* Each score is computed exactly once from the running aggregates —
+   no rescan of the window, and no duplicated second pass for the
+   pattern list. The caller holds (at least) a read lock on the
+   client's shard. The detector set, weights and windows come from the
+   compile-time composed pipeline (WC_SCORING_PIPELINE, default: the
+   historical five-detector composition). */
+AnomalyScore BehaviorAnalyzer::scoreClientLocked(const std::string& client_id,
+                                                 const ClientHistory& client_hist) {
+    return ActiveScoringPipeline::evaluate(client_id, client_hist);
+}
+
+/* Parallel sweep over the whole client map. Shards are the natural unit
+   of both locking and stealing: one worker holds one shard's read lock
+   at a time, so workers never contend with each other, only (briefly)
+   with the request path for that shard. Each worker drains its own
+   deque back-to-front and steals front-to-back from the fullest
+   neighbour when empty — classic work stealing, sized so a few heavy
+   shards end up spread across the pool. */
+std::vector<AnomalyScore> BehaviorAnalyzer::analyzeAll(float threshold, size_t max_workers) {
+    size_t worker_count = max_workers != 0
+        ? max_workers
+        : std::max<size_t>(1, std::thread::hardware_concurrency());
+    worker_count = std::min(worker_count, shards.size());
+
+    /* Per-worker shard deques, seeded round-robin */
+    struct WorkerQueue {
+        std::deque<size_t> shard_indices;
+        std::mutex mutex;
+    };
+    std::vector<WorkerQueue> queues(worker_count);
+    for (size_t i = 0; i < shards.size(); ++i) {
+        queues[i % worker_count].shard_indices.push_back(i);
+    }
+
+    std::vector<std::vector<AnomalyScore>> partials(worker_count);
+
+    auto worker = [&](size_t self) {
+        auto& results = partials[self];
+        for (;;) {
+            size_t shard_index = shards.size(); // sentinel: nothing found
+
+            /* Own queue first (back), then steal from the fullest peer
+               (front, to take the work its owner will reach last) */
+            {
+                std::lock_guard<std::mutex> lock(queues[self].mutex);
+                if (!queues[self].shard_indices.empty()) {
+                    shard_index = queues[self].shard_indices.back();
+                    queues[self].shard_indices.pop_back();
+                }
+            }
+            if (shard_index == shards.size()) {
+                size_t victim = worker_count;
+                size_t victim_size = 0;
+                for (size_t other = 0; other < worker_count; ++other) {
+                    if (other == self) continue;
+                    std::lock_guard<std::mutex> lock(queues[other].mutex);
+                    if (queues[other].shard_indices.size() > victim_size) {
+                        victim = other;
+                        victim_size = queues[other].shard_indices.size();
+                    }
+                }
+                if (victim == worker_count) return; // everything drained
+                std::lock_guard<std::mutex> lock(queues[victim].mutex);
+                if (queues[victim].shard_indices.empty()) continue; // raced; rescan
+                shard_index = queues[victim].shard_indices.front();
+                queues[victim].shard_indices.pop_front();
+            }
+
+            auto& shard = *shards[shard_index];
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            for (const auto& [client_id, hist] : shard.history) {
+                if (hist.empty()) continue;
+                AnomalyScore score = scoreClientLocked(client_id, hist);
+                if (score.score > threshold) {
+                    results.push_back(std::move(score));
+                }
+            }
+        }
+    };
+
+    if (worker_count == 1) {
+        worker(0);
+    } else {
+        std::vector<std::thread> pool;
+        pool.reserve(worker_count);
+        for (size_t i = 0; i < worker_count; ++i) pool.emplace_back(worker, i);
+        for (auto& t : pool) t.join();
+    }
+
+    std::vector<AnomalyScore> merged;
+    size_t total = 0;
+    for (const auto& partial : partials) total += partial.size();
+    merged.reserve(total);
+    for (auto& partial : partials) {
+        merged.insert(merged.end(),
+                      std::make_move_iterator(partial.begin()),
+                      std::make_move_iterator(partial.end()));
+    }
+    std::sort(merged.begin(), merged.end(),
+              [](const AnomalyScore& a, const AnomalyScore& b) { return a.score > b.score; });
+    return merged;
+}
+
+/* Note: These internal calculation functions assume the caller holds the lock.
+   Each kernel reads the running aggregates maintained by append() — worst
+   case O(log n) for the windowed failure count, O(1) for the rest. */
+/* The legacy per-detector entry points delegate to the default-tuned
+   scoring policies so the logic lives in exactly one place */
+float BehaviorAnalyzer::calculateRapidFailureScore(const ClientHistory& history) {
+    return scoring::RapidFailure<>::score(history, engineNow());
+}
+
+float BehaviorAnalyzer::calculateEnumerationScore(const ClientHistory& history) {
+    return scoring::Enumeration<>::score(history, engineNow());
+}
+
+float BehaviorAnalyzer::calculatePayloadScore(const ClientHistory& history) {
+    return scoring::Payload::score(history, engineNow());
+}
+
+float BehaviorAnalyzer::calculateTimingScore(const ClientHistory& history) {
+    return scoring::Timing<>::score(history, engineNow());
+}
+
+float BehaviorAnalyzer::calculateResourceScore(const ClientHistory& history) {
+    return scoring::ResourceAbuse<>::score(history, engineNow());
+}
+
+// These dummy implementations were missing in public API but needed for compilation
+float BehaviorAnalyzer::calculateAnomalyScore(const std::string& client_id) {
+    // Redirects to main logic to avoid code duplication
+    return analyzeBehavior(client_id).score;
+}
+std::vector<BehaviorPattern> BehaviorAnalyzer::detectPatterns(const std::string& client_id) {
+    return analyzeBehavior(client_id).detected_patterns;
+}
+
+/* ---------------------------------------------------------
+   AdaptiveThresholdManager Implementation
+--------------------------------------------------------- */
+
+static std::mutex threshold_mutex; // Config changes are rare, standard mutex is fine
+
+AdaptiveThresholdManager::AdaptiveThresholdManager() {
+    thresholds["rate_limit"] = 100.0f;
+    thresholds["anomaly_score"] = 0.5f;
+    thresholds["failure_count"] = 5.0f;
+    thresholds["enumeration_attempts"] = 20.0f;
+}
+
+void AdaptiveThresholdManager::updateThreshold(const std::string& metric, float new_threshold) {
+    std::lock_guard<std::mutex> lock(threshold_mutex);
+    thresholds[metric] = new_threshold;
+}
+
+float AdaptiveThresholdManager::getThreshold(const std::string& metric) const {
+    std::lock_guard<std::mutex> lock(threshold_mutex);
+    auto it = thresholds.find(metric);
+    return (it != thresholds.end()) ? it->second : 0.5f;
+}
+
+void AdaptiveThresholdManager::reinforceThresholds(const AnomalyScore& anomaly) {
+    std::lock_guard<std::mutex> lock(threshold_mutex);
+    hit_counts[std::to_string(static_cast<int>(anomaly.level))]++;
+    
+    /* Harden thresholds dynamically under attack */
+    if (anomaly.level >= ThreatLevel::HIGH) {
+        thresholds["rate_limit"] = std::max(10.0f, thresholds["rate_limit"] * 0.9f); // Never go below 10
+        thresholds["anomaly_score"] = std::max(0.2f, thresholds["anomaly_score"] * 0.95f);
+    }
+}
+
+void AdaptiveThresholdManager::resetThresholds() {
+    std::lock_guard<std::mutex> lock(threshold_mutex);
+    thresholds.clear();
+    hit_counts.clear();
+    // Restore defaults
+    thresholds["rate_limit"] = 100.0f;
+}
+
+void AdaptiveThresholdManager::snapshotState(std::vector<uint8_t>& out) const {
+    std::lock_guard<std::mutex> lock(threshold_mutex);
+    SnapshotWriter w{out};
+
+    w.u32((uint32_t)thresholds.size());
+    for (const auto& [metric, value] : thresholds) {
+        w.str(metric);
+        w.f32(value);
+    }
+    w.u32((uint32_t)hit_counts.size());
+    for (const auto& [metric, count] : hit_counts) {
+        w.str(metric);
+        w.u32(count);
+    }
+}
+
+bool AdaptiveThresholdManager::restoreState(const uint8_t* data, size_t len) {
+    SnapshotReader r{data, len};
+
+    std::map<std::string, float> new_thresholds;
+    std::map<std::string, uint32_t> new_hits;
+
+    uint32_t n;
+    if (!r.u32(n)) return false;
+    for (uint32_t i = 0; i < n; ++i) {
+        std::string metric;
+        float value;
+        if (!r.str(metric) || !r.f32(value)) return false;
+        new_thresholds[metric] = value;
+    }
+    if (!r.u32(n)) return false;
+    for (uint32_t i = 0; i < n; ++i) {
+        std::string metric;
+        uint32_t count;
+        if (!r.str(metric) || !r.u32(count)) return false;
+        new_hits[metric] = count;
+    }
+
+    std::lock_guard<std::mutex> lock(threshold_mutex);
+    thresholds = std::move(new_thresholds);
+    hit_counts = std::move(new_hits);
+    return true;
+}
+
+/* ---------------------------------------------------------
+   LockFreeTokenBucketTable Implementation
+--------------------------------------------------------- */
+
+LockFreeTokenBucketTable::LockFreeTokenBucketTable(size_t capacity, uint32_t default_rps)
+    : default_rps(default_rps), epoch(std::chrono::steady_clock::now()) {
+    size_t count = roundUpToPowerOfTwo(std::max<size_t>(1024, capacity));
+    slot_mask = count - 1;
+    slots = std::make_unique<Slot[]>(count);
+}
+
+uint64_t LockFreeTokenBucketTable::nowMs() const {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - epoch).count();
+}
+
+/* Linear probing with a bounded probe sequence. Insertion claims an empty
+   slot by CAS-ing the key from 0; losers re-check the published key. */
+LockFreeTokenBucketTable::Slot* LockFreeTokenBucketTable::findSlot(uint64_t key_hash, bool insert_if_missing) {
+    for (size_t i = 0; i < kMaxProbes; ++i) {
+        Slot& slot = slots[(key_hash + i) & slot_mask];
+        uint64_t existing = slot.key.load(std::memory_order_acquire);
+        if (existing == key_hash) return &slot;
+        if (existing == 0) {
+            if (!insert_if_missing) return nullptr;
+            uint64_t expected = 0;
+            if (slot.key.compare_exchange_strong(expected, key_hash,
+                                                 std::memory_order_acq_rel)) {
+                /* state == 0 already means "full bucket at t=0": the first
+                   refill computes a large elapsed delta and tops it up */
+                return &slot;
+            }
+            if (expected == key_hash) return &slot; // lost the race to ourselves
+        }
+    }
+    return nullptr; // probe window exhausted
+}
+
+LockFreeTokenBucketTable::Outcome LockFreeTokenBucketTable::tryConsume(const std::string& client_id) {
+    uint64_t h = std::hash<std::string>{}(client_id);
+    if (h == 0) h = 1; // 0 is the empty-slot sentinel
+    return tryConsumeHash(h, 1);
+}
+
+LockFreeTokenBucketTable::Outcome LockFreeTokenBucketTable::tryConsumeHash(
+        uint64_t key_hash, uint32_t cost, uint32_t fallback_rps) {
+    if (key_hash == 0) key_hash = 1;
+
+    Slot* slot = findSlot(key_hash, true);
+    if (!slot) return Outcome::TABLE_FULL;
+
+    uint32_t rate = slot->rate.load(std::memory_order_relaxed);
+    if (rate == 0) rate = fallback_rps ? fallback_rps : default_rps;
+    uint64_t capacity = std::min<uint64_t>(rate, kTokenMask);
+
+    uint64_t now = nowMs();
+    uint64_t state = slot->state.load(std::memory_order_relaxed);
+
+    /* CAS loop: refill from elapsed time, then take `cost` tokens */
+    for (;;) {
+        uint64_t last = state >> kTokenBits;
+        uint64_t tokens = state & kTokenMask;
+
+        uint64_t elapsed = (now > last) ? (now - last) : 0;
+        uint64_t refill = (elapsed * rate) / 1000;
+        if (refill > 0 || tokens > capacity) {
+            tokens = std::min<uint64_t>(capacity, tokens + refill);
+            last = now;
+        }
+
+        if (tokens < cost) {
+            /* No refill pending either -> genuinely over the limit */
+            if (refill == 0) return Outcome::LIMITED;
+            uint64_t desired = (last << kTokenBits) | tokens; // publish the refill
+            if (slot->state.compare_exchange_weak(state, desired, std::memory_order_relaxed))
+                return Outcome::LIMITED;
+            continue;
+        }
+
+        uint64_t desired = (last << kTokenBits) | (tokens - cost);
+        if (slot->state.compare_exchange_weak(state, desired, std::memory_order_relaxed))
+            return Outcome::ALLOWED;
+        /* contended: state was reloaded by compare_exchange_weak, retry */
+    }
+}
+
+/* Returns tokens charged by a cascading check whose deeper level then
+   denied. Never creates a slot — a missing bucket has nothing to give
+   back. */
+void LockFreeTokenBucketTable::refundHash(uint64_t key_hash, uint32_t cost,
+                                          uint32_t fallback_rps) {
+    if (key_hash == 0) key_hash = 1;
+
+    Slot* slot = findSlot(key_hash, false);
+    if (!slot) return;
+
+    uint32_t rate = slot->rate.load(std::memory_order_relaxed);
+    if (rate == 0) rate = fallback_rps ? fallback_rps : default_rps;
+    uint64_t capacity = std::min<uint64_t>(rate, kTokenMask);
+
+    uint64_t state = slot->state.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t last = state >> kTokenBits;
+        uint64_t tokens = std::min<uint64_t>(capacity, (state & kTokenMask) + cost);
+        uint64_t desired = (last << kTokenBits) | tokens;
+        if (slot->state.compare_exchange_weak(state, desired, std::memory_order_relaxed))
+            return;
+    }
+}
+
+void LockFreeTokenBucketTable::setClientRate(const std::string& client_id, uint32_t rps) {
+    uint64_t h = std::hash<std::string>{}(client_id);
+    if (h == 0) h = 1;
+    setRateForHash(h, rps);
+}
+
+void LockFreeTokenBucketTable::setRateForHash(uint64_t client_hash, uint32_t rps) {
+    if (client_hash == 0) client_hash = 1;
+    Slot* slot = findSlot(client_hash, true);
+    if (slot) slot->rate.store(rps, std::memory_order_relaxed);
+}
+
+void LockFreeTokenBucketTable::reset() {
+    for (size_t i = 0; i <= slot_mask; ++i) {
+        slots[i].state.store(0, std::memory_order_relaxed);
+        slots[i].rate.store(0, std::memory_order_relaxed);
+        slots[i].key.store(0, std::memory_order_release);
+    }
+}
+
+/* ---------------------------------------------------------
+   RateLimitingPolicy Implementation
+   Fast path: lock-free token buckets. Slow path: sharded mutexes.
+--------------------------------------------------------- */
+
+RateLimitingPolicy::RateLimitingPolicy(uint32_t default_rps, size_t shard_count)
+    : default_rps(default_rps),
+      bucket_table(1 << 16, default_rps) {
+    size_t count = roundUpToPowerOfTwo(std::max<size_t>(1, shard_count));
+    shard_mask = count - 1;
+    shards.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        shards.push_back(std::make_unique<PolicyShard>());
+    }
+}
+
+bool RateLimitingPolicy::checkLimit(const std::string& client_id) {
+    bool allowed;
+    if (lock_free_mode.load(std::memory_order_relaxed)) {
+        auto outcome = bucket_table.tryConsume(client_id);
+        if (outcome != LockFreeTokenBucketTable::Outcome::TABLE_FULL) {
+            allowed = (outcome == LockFreeTokenBucketTable::Outcome::ALLOWED);
+            TelemetryHub::instance().countCheckLimit(allowed);
+            return allowed;
+        }
+        /* Table saturated (probe window exhausted): degrade to the mutex
+           path rather than failing open */
+    }
+    allowed = checkLimitLocked(client_id);
+    TelemetryHub::instance().countCheckLimit(allowed);
+    return allowed;
+}
+
+bool RateLimitingPolicy::checkLimitLocked(const std::string& client_id) {
+    auto& shard = shardFor(client_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto& policy = shard.policies[client_id];
+    auto now = engineNow();
+    
+    // Initialize defaults if new client
+    if (policy.requests_per_second == 0) policy.requests_per_second = default_rps;
+
+    if (std::chrono::duration_cast<std::chrono::seconds>(now - policy.last_reset).count() >= 1) {
+        policy.request_count = 0;
+        policy.last_reset = now;
+    }
+    
+    if (policy.request_count >= policy.requests_per_second) {
+        return false; // LIMIT EXCEEDED
+    }
+    
+    policy.request_count++;
+    return true; // ALLOWED
+}
+
+void RateLimitingPolicy::enforceDynamicLimits(const AnomalyScore& anomaly) {
+    auto& shard = shardFor(anomaly.client_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto& policy = shard.policies[anomaly.client_id];
+
+    if (anomaly.level >= ThreatLevel::HIGH) {
+        policy.requests_per_second = std::max(1u, default_rps / 10);
+    } else if (anomaly.level >= ThreatLevel::MEDIUM) {
+        policy.requests_per_second = std::max(5u, default_rps / 5);
+    } else {
+        return;
+    }
+
+    /* Slow path is allowed to block; propagate the tightened cap to the
+       lock-free fast path as a plain atomic store */
+    bucket_table.setClientRate(anomaly.client_id, policy.requests_per_second);
+}
+
+/* Mirror of the enforceDynamicLimits tightening, for gossip deltas */
+uint32_t RateLimitingPolicy::capForLevel(ThreatLevel level) const {
+    if (level >= ThreatLevel::HIGH) return std::max(1u, default_rps / 10);
+    if (level >= ThreatLevel::MEDIUM) return std::max(5u, default_rps / 5);
+    return 0; // no cap change
+}
+
+void RateLimitingPolicy::applyRemoteCap(uint64_t client_hash, uint32_t rps) {
+    /* Only the lock-free table: the delta carries no client ID, and the
+       fast path consults the table before the sharded policies anyway */
+    bucket_table.setRateForHash(client_hash, rps);
+}
+
+/* ---------------------------------------------------------
+   Hierarchical limiting: global -> org -> client -> (org, resource)
+--------------------------------------------------------- */
+
+namespace {
+/* Bucket-key domains; arbitrary odd constants keep the levels from
+   aliasing each other in the shared slot table */
+constexpr uint64_t kGlobalBucketTag   = 0x476c6f62616c4c31ULL;
+constexpr uint64_t kOrgBucketTag      = 0x4f72674275636b31ULL;
+constexpr uint64_t kResourceBucketTag = 0x5265734275636b31ULL;
+} // namespace
+
+uint64_t RateLimitingPolicy::scopedKey(uint64_t domain_tag, uint64_t h) {
+    /* splitmix64-style finalizer over the tagged hash */
+    uint64_t x = h ^ domain_tag;
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x ? x : 1;
+}
+
+void RateLimitingPolicy::configureHierarchy(uint32_t global_rps_,
+                                            uint32_t org_rps_default_,
+                                            uint32_t resource_rps_default_) {
+    {
+        std::unique_lock<std::shared_mutex> lock(hierarchy_mutex);
+        global_rps = global_rps_;
+        org_rps_default = org_rps_default_;
+        resource_rps_default = resource_rps_default_;
+    }
+    hierarchy_enabled = (global_rps_ > 0);
+}
+
+void RateLimitingPolicy::setOrgRate(const std::string& org_id, uint32_t rps) {
+    bucket_table.setRateForHash(
+        scopedKey(kOrgBucketTag, std::hash<std::string>{}(org_id)), rps);
+}
+
+void RateLimitingPolicy::setResourceCost(const std::string& resource_id, uint32_t cost) {
+    std::unique_lock<std::shared_mutex> lock(hierarchy_mutex);
+    resource_costs[resource_id] = std::max<uint32_t>(1, cost);
+}
+
+bool RateLimitingPolicy::checkLimitScoped(const std::string& org_id,
+                                          const std::string& client_id,
+                                          const std::string& resource_id,
+                                          uint32_t cost_override) {
+    if (!hierarchy_enabled.load(std::memory_order_relaxed)) {
+        return checkLimit(client_id);
+    }
+
+    uint32_t cost = cost_override;
+    uint32_t g_rps, o_rps, r_rps;
+    {
+        std::shared_lock<std::shared_mutex> lock(hierarchy_mutex);
+        g_rps = global_rps;
+        o_rps = org_rps_default;
+        r_rps = resource_rps_default;
+        if (cost == 0) {
+            auto it = resource_costs.find(resource_id);
+            cost = (it != resource_costs.end()) ? it->second : 1;
+        }
+    }
+
+    using Outcome = LockFreeTokenBucketTable::Outcome;
+    uint64_t org_hash = org_id.empty() ? 0 : std::hash<std::string>{}(org_id);
+
+    /* Levels charged so far, for refund if a deeper level denies. A
+       saturated table (no free slot) fails open at the shared levels —
+       the per-client check below still stands. */
+    struct ChargedLevel { uint64_t key; uint32_t fallback; };
+    ChargedLevel charged[3];
+    size_t n_charged = 0;
+
+    auto deny = [&]() {
+        for (size_t i = 0; i < n_charged; ++i) {
+            bucket_table.refundHash(charged[i].key, cost, charged[i].fallback);
+        }
+        TelemetryHub::instance().countCheckLimit(false);
+        return false;
+    };
+
+    uint64_t global_key = scopedKey(kGlobalBucketTag, 0);
+    if (bucket_table.tryConsumeHash(global_key, cost, g_rps) == Outcome::LIMITED) {
+        return deny();
+    }
+    charged[n_charged++] = { global_key, g_rps };
+
+    if (org_hash != 0) {
+        uint64_t org_key = scopedKey(kOrgBucketTag, org_hash);
+        if (bucket_table.tryConsumeHash(org_key, cost, o_rps) == Outcome::LIMITED) {
+            return deny();
+        }
+        charged[n_charged++] = { org_key, o_rps };
+    }
+
+    /* Client level shares its bucket with the flat checkLimit path, so
+       dynamic caps and gossiped caps keep applying. TABLE_FULL degrades
+       to the mutex path, as the flat check does. */
+    uint64_t client_hash = std::hash<std::string>{}(client_id);
+    auto client_outcome = bucket_table.tryConsumeHash(client_hash ? client_hash : 1, cost);
+    if (client_outcome == Outcome::LIMITED) return deny();
+    if (client_outcome == Outcome::TABLE_FULL && !checkLimitLocked(client_id)) {
+        return deny();
+    }
+
+    if (org_hash != 0 && !resource_id.empty()) {
+        uint64_t res_key = scopedKey(kResourceBucketTag,
+                                     org_hash * 0x100000001b3ULL ^
+                                     std::hash<std::string>{}(resource_id));
+        if (bucket_table.tryConsumeHash(res_key, cost, r_rps) == Outcome::LIMITED) {
+            charged[n_charged++] = { client_hash ? client_hash : 1, 0 };
+            return deny();
+        }
+    }
+
+    TelemetryHub::instance().countCheckLimit(true);
+    return true;
+}
+
+void RateLimitingPolicy::resetPolicies() {
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->policies.clear();
+    }
+    bucket_table.reset();
+}
+
+/* ---------------------------------------------------------
+   ThreatResponseEngine Implementation
+--------------------------------------------------------- */
+
+static std::mutex response_mutex;
+
+ThreatResponseEngine::ThreatResponseEngine() {}
+
+void ThreatResponseEngine::respondToThreat(const AnomalyScore& anomaly) {
+    if (anomaly.level >= ThreatLevel::CRITICAL) {
+        isolateClient(anomaly.client_id, anomaly.level);
+    } else if (anomaly.level >= ThreatLevel::HIGH) {
+        throttleClient(anomaly.client_id, 0.5f);
+        generateAlert(anomaly);
+    }
+}
+
+void ThreatResponseEngine::isolateClient(const std::string& client_id, ThreatLevel level) {
+    auto now = engineNow();
+    auto horizon = (level >= ThreatLevel::CRITICAL) ? kCriticalIsolation : kDefaultIsolation;
+
+    std::lock_guard<std::mutex> lock(response_mutex);
+    /* Re-isolating extends the release horizon from now */
+    isolated_clients[client_id] = {
+        level,
+        now,
+        now + horizon,
+        "Threat level exceeded CRITICAL threshold - ISOLATION ENFORCED"
+    };
+    /* One ring write instead of a flushed std::cout line: under attack
+       the alert volume is exactly when the hot path can least afford a
+       stream mutex and a flush per event */
+    TelemetryHub::instance().emit(TelemetryHub::EventType::CLIENT_ISOLATED,
+                                  std::hash<std::string>{}(client_id), 0.0f, level);
+}
+
+bool ThreatResponseEngine::isIsolated(const std::string& client_id) {
+    auto now = engineNow();
+
+    std::lock_guard<std::mutex> lock(response_mutex);
+    auto it = isolated_clients.find(client_id);
+    if (it == isolated_clients.end()) return false;
+    if (now >= it->second.release_at) {
+        isolated_clients.erase(it); // timed auto-release
+        return false;
+    }
+    return true;
+}
+
+void ThreatResponseEngine::releaseClient(const std::string& client_id) {
+    std::lock_guard<std::mutex> lock(response_mutex);
+    isolated_clients.erase(client_id);
+}
+
+size_t ThreatResponseEngine::isolatedCount() {
+    std::lock_guard<std::mutex> lock(response_mutex);
+    return isolated_clients.size();
+}
+
+void ThreatResponseEngine::throttleClient(const std::string& client_id, float reduction_factor) {
+    // Integration point with Load Balancer or Reverse Proxy
+    TelemetryHub::instance().emit(TelemetryHub::EventType::CLIENT_THROTTLED,
+                                  std::hash<std::string>{}(client_id),
+                                  reduction_factor, ThreatLevel::HIGH);
+}
+
+void ThreatResponseEngine::rerouteTraffic(const std::string& client_id) {
+    // Honeypot redirection logic would go here
+    TelemetryHub::instance().emit(TelemetryHub::EventType::TRAFFIC_REROUTED,
+                                  std::hash<std::string>{}(client_id),
+                                  0.0f, ThreatLevel::MEDIUM);
+}
+
+void ThreatResponseEngine::generateAlert(const AnomalyScore& anomaly) {
+    // SIEM / dashboard delivery happens in the exporter's sinks
+    TelemetryHub::instance().emit(TelemetryHub::EventType::ANOMALY_ALERT,
+                                  std::hash<std::string>{}(anomaly.client_id),
+                                  anomaly.score, anomaly.level);
+}
+
+void ThreatResponseEngine::snapshotIsolation(std::vector<uint8_t>& out, TimePoint now) {
+    std::lock_guard<std::mutex> lock(response_mutex);
+    SnapshotWriter w{out};
+
+    w.u32((uint32_t)isolated_clients.size());
+    for (const auto& [client_id, iso] : isolated_clients) {
+        w.str(client_id);
+        w.u8(static_cast<uint8_t>(iso.level));
+        w.i64(std::chrono::duration_cast<std::chrono::milliseconds>(now - iso.isolation_start).count());
+        w.str(iso.reason);
+    }
+}
+
+bool ThreatResponseEngine::restoreIsolation(const uint8_t* data, size_t len, TimePoint now) {
+    SnapshotReader r{data, len};
+
+    uint32_t n;
+    if (!r.u32(n)) return false;
+
+    std::unordered_map<std::string, ClientIsolation> restored;
+    restored.reserve(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        std::string client_id, reason;
+        uint8_t level;
+        int64_t age_ms;
+        if (!r.str(client_id) || !r.u8(level) || !r.i64(age_ms) || !r.str(reason) ||
+            level > static_cast<uint8_t>(ThreatLevel::CRITICAL)) {
+            return false;
+        }
+        auto restored_level = static_cast<ThreatLevel>(level);
+        auto start = now - std::chrono::milliseconds(age_ms);
+        auto horizon = (restored_level >= ThreatLevel::CRITICAL) ? kCriticalIsolation : kDefaultIsolation;
+        restored[client_id] = { restored_level, start, start + horizon, reason };
+    }
+
+    std::lock_guard<std::mutex> lock(response_mutex);
+    isolated_clients = std::move(restored);
+    return true;
+}
+
+/* ---------------------------------------------------------
+   SharedDecisionCache Implementation
+   Seqlock slots in a POSIX shared-memory segment
+--------------------------------------------------------- */
+
+uint64_t SharedDecisionCache::wallClockMs() {
+    /* Wall clock (not steady) on purpose: expiry must compare across
+       processes that mapped the segment at different times */
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+SharedDecisionCache::~SharedDecisionCache() {
+    close();
+}
+
+void SharedDecisionCache::close() {
+    if (header) {
+        munmap(header, mapped_size);
+        header = nullptr;
+        slots = nullptr;
+    }
+    if (owner && !shm_name.empty()) {
+        shm_unlink(shm_name.c_str());
+    }
+    shm_name.clear();
+    owner = false;
+}
+
+bool SharedDecisionCache::create(const std::string& name, size_t slot_count) {
+    close();
+    size_t count = roundUpToPowerOfTwo(std::max<size_t>(1024, slot_count));
+    size_t size = sizeof(Header) + count * sizeof(Slot);
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0) return false;
+    if (ftruncate(fd, (off_t)size) != 0) {
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    header = (Header*)mem;
+    slots = (Slot*)((char*)mem + sizeof(Header));
+    mapped_size = size;
+    slot_mask = count - 1;
+    shm_name = name;
+    owner = true;
+
+    for (size_t i = 0; i < count; ++i) {
+        slots[i].sequence.store(0, std::memory_order_relaxed);
+        slots[i].client_hash = 0;
+        slots[i].expiry_ms = 0;
+        slots[i].score = 0.0f;
+        slots[i].level = 0;
+    }
+    header->slot_count = count;
+    header->version = kVersion;
+    /* Magic written last: readers treat the segment as valid only once
+       it is fully initialized */
+    header->magic = kMagic;
+    return true;
+}
+
+bool SharedDecisionCache::open(const std::string& name) {
+    close();
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) return false;
+
+    Header probe;
+    if (::read(fd, &probe, sizeof(probe)) != (ssize_t)sizeof(probe) ||
+        probe.magic != kMagic || probe.version != kVersion) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = sizeof(Header) + probe.slot_count * sizeof(Slot);
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) return false;
+
+    header = (Header*)mem;
+    slots = (Slot*)((char*)mem + sizeof(Header));
+    mapped_size = size;
+    slot_mask = probe.slot_count - 1;
+    shm_name = name;
+    owner = false;
+    return true;
+}
+
+void SharedDecisionCache::publish(const std::string& client_id, float score, ThreatLevel level, uint64_t ttl_ms) {
+    if (!header) return;
+    uint64_t h = std::hash<std::string>{}(client_id);
+    if (h == 0) h = 1;
+    Slot& slot = slots[h & slot_mask];
+
+    uint64_t seq = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(seq + 1, std::memory_order_release); // odd: write in flight
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.client_hash = h;
+    slot.expiry_ms = wallClockMs() + ttl_ms;
+    slot.score = score;
+    slot.level = (uint8_t)level;
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.sequence.store(seq + 2, std::memory_order_release); // even: consistent
+}
+
+bool SharedDecisionCache::read(const std::string& client_id, float* score, ThreatLevel* level) const {
+    if (!header) return false;
+    uint64_t h = std::hash<std::string>{}(client_id);
+    if (h == 0) h = 1;
+    const Slot& slot = slots[h & slot_mask];
+
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        uint64_t seq1 = slot.sequence.load(std::memory_order_acquire);
+        if (seq1 & 1) continue; // writer in flight
+        uint64_t hash = slot.client_hash;
+        uint64_t expiry = slot.expiry_ms;
+        float s = slot.score;
+        uint8_t l = slot.level;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t seq2 = slot.sequence.load(std::memory_order_acquire);
+        if (seq1 != seq2) continue; // torn read, retry
+
+        if (hash != h) return false;            // empty or collision
+        if (wallClockMs() >= expiry) return false; // stale: force re-analysis
+        if (score) *score = s;
+        if (level) *level = (ThreatLevel)l;
+        return true;
+    }
+    return false; // persistent contention: treat as a miss
+}
+
+/* ---------------------------------------------------------
+   AdmissionPrefilter Implementation
+   Count-min + Bloom sketches for the cheap admission tier
+--------------------------------------------------------- */
+
+namespace {
+
+/* splitmix64 finalizer: derives the per-row count-min hashes and the
+   Bloom probe positions from one input hash */
+inline uint64_t mixHash(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+} // namespace
+
+AdmissionPrefilter::AdmissionPrefilter()
+    : counters(new std::atomic<uint32_t>[kRows << kColsLog2]),
+      bloom(new std::atomic<uint64_t>[kBloomWords]),
+      epoch(std::chrono::steady_clock::now()) {
+    for (size_t i = 0; i < (kRows << kColsLog2); ++i) counters[i].store(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < kBloomWords; ++i) bloom[i].store(0, std::memory_order_relaxed);
+}
+
+/* Exponential decay: once per window the counters are halved, so the
+   estimate tracks recent rate without a hard reset cliff. One thread
+   does the halving; the others carry on against the live table. */
+void AdmissionPrefilter::maybeDecay(uint64_t now_ms) {
+    uint64_t start = window_start_ms.load(std::memory_order_relaxed);
+    if (now_ms - start < kWindowMs) return;
+    if (!window_start_ms.compare_exchange_strong(start, now_ms, std::memory_order_relaxed)) return;
+
+    std::lock_guard<std::mutex> lock(decay_mutex);
+    for (size_t i = 0; i < (kRows << kColsLog2); ++i) {
+        uint32_t v = counters[i].load(std::memory_order_relaxed);
+        if (v) counters[i].store(v >> 1, std::memory_order_relaxed);
+    }
+}
+
+bool AdmissionPrefilter::admitFast(uint64_t client_hash, uint64_t resource_hash) {
+    uint64_t now_ms = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - epoch).count();
+    maybeDecay(now_ms);
+
+    /* Count-min update + estimate (min over rows of the bumped values) */
+    uint32_t estimate = UINT32_MAX;
+    uint64_t h = client_hash;
+    constexpr size_t col_mask = (1u << kColsLog2) - 1;
+    for (size_t row = 0; row < kRows; ++row) {
+        h = mixHash(h);
+        auto& counter = counters[(row << kColsLog2) | (h & col_mask)];
+        uint32_t bumped = counter.fetch_add(1, std::memory_order_relaxed) + 1;
+        estimate = std::min(estimate, bumped);
+    }
+
+    /* Bloom test-and-set of the (client, resource) pair: two probes */
+    uint64_t pair = mixHash(client_hash ^ mixHash(resource_hash));
+    bool pair_known = true;
+    for (int probe = 0; probe < 2; ++probe) {
+        uint64_t bit = (probe == 0 ? pair : mixHash(pair)) & (kBloomWords * 64 - 1);
+        uint64_t mask = 1ULL << (bit & 63);
+        uint64_t prev = bloom[bit >> 6].fetch_or(mask, std::memory_order_relaxed);
+        if (!(prev & mask)) pair_known = false;
+    }
+
+    /* Sampled promotion: even boring clients get the full path once in a
+       while so their history keeps accumulating */
+    bool sampled = (sample_counter.fetch_add(1, std::memory_order_relaxed) & kSampleMask) == 0;
+
+    return !sampled && pair_known && estimate <= kBoringRate;
+}
+
+/* ---------------------------------------------------------
+   TelemetryHub Implementation
+   Per-thread SPSC event rings + background exporter
+--------------------------------------------------------- */
+
+TelemetryHub& TelemetryHub::instance() {
+    static TelemetryHub hub;
+    return hub;
+}
+
+TelemetryHub::~TelemetryHub() {
+    stop();
+}
+
+/* One ring per thread, registered on first emit. The handle's destructor
+   retires the ring at thread exit; the registry keeps retired rings so
+   the exporter can still drain their remaining events. */
+TelemetryHub::ThreadRing* TelemetryHub::threadRing() {
+    struct RingHandle {
+        ThreadRing* ring = nullptr;
+        ~RingHandle() {
+            if (ring) ring->retired.store(true, std::memory_order_release);
+        }
+    };
+    thread_local RingHandle handle;
+
+    if (!handle.ring) {
+        auto owned = std::make_unique<ThreadRing>();
+        handle.ring = owned.get();
+        std::lock_guard<std::mutex> lock(ring_registry_mutex);
+        rings.push_back(std::move(owned));
+    }
+    return handle.ring;
+}
+
+void TelemetryHub::emit(EventType type, uint64_t client_hash, float score, ThreatLevel level) {
+    ThreadRing* ring = threadRing();
+
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= kRingSize) {
+        /* Exporter is behind: drop and count. The hot path never waits. */
+        dropped_events.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Event& slot = ring->events[head & (kRingSize - 1)];
+    slot.timestamp_ms = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    slot.client_hash = client_hash;
+    slot.score = score;
+    slot.level = static_cast<uint8_t>(level);
+    slot.type = static_cast<uint8_t>(type);
+
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void TelemetryHub::countCheckLimit(bool allowed) {
+    (allowed ? checklimit_allowed : checklimit_blocked)
+        .fetch_add(1, std::memory_order_relaxed);
+}
+
+void TelemetryHub::recordAnalyzeLatency(uint64_t nanos) {
+    uint64_t us = nanos / 1000;
+    size_t bucket = 0;
+    while (bucket + 1 < kLatencyBuckets && us >= (1ULL << (bucket + 1))) ++bucket;
+    analyze_latency_us[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void TelemetryHub::addSink(std::shared_ptr<Sink> sink) {
+    if (!sink) return;
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    sinks.push_back(std::move(sink));
+}
+
+void TelemetryHub::start() {
+    if (exporter_running.exchange(true)) return;
+    exporter_stop = false;
+    exporter_thread = std::thread(&TelemetryHub::exporterLoop, this);
+}
+
+void TelemetryHub::stop() {
+    if (!exporter_running.exchange(false)) return;
+    exporter_stop = true;
+    if (exporter_thread.joinable()) exporter_thread.join();
+
+    /* Final drain so shutdown events reach the sinks */
+    std::vector<Event> scratch;
+    drainRings(scratch);
+}
+
+void TelemetryHub::drainRings(std::vector<Event>& scratch) {
+    scratch.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(ring_registry_mutex);
+        for (auto& ring : rings) {
+            uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            while (tail != head) {
+                scratch.push_back(ring->events[tail & (kRingSize - 1)]);
+                ++tail;
+            }
+            ring->tail.store(tail, std::memory_order_release);
+        }
+    }
+
+    if (scratch.empty()) return;
+
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    for (auto& sink : sinks) {
+        sink->consume(scratch.data(), scratch.size());
+    }
+}
+
+void TelemetryHub::exporterLoop() {
+    std::vector<Event> scratch;
+    scratch.reserve(kRingSize);
+    while (!exporter_stop.load(std::memory_order_relaxed)) {
+        drainRings(scratch);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+std::string TelemetryHub::renderPrometheus() const {
+    std::ostringstream out;
+    out << "# TYPE workchain_checklimit_total counter\n"
+        << "workchain_checklimit_total{outcome=\"allowed\"} "
+        << checklimit_allowed.load(std::memory_order_relaxed) << "\n"
+        << "workchain_checklimit_total{outcome=\"blocked\"} "
+        << checklimit_blocked.load(std::memory_order_relaxed) << "\n"
+        << "# TYPE workchain_telemetry_dropped_total counter\n"
+        << "workchain_telemetry_dropped_total "
+        << dropped_events.load(std::memory_order_relaxed) << "\n"
+        << "# TYPE workchain_analyze_latency_us histogram\n";
+
+    uint64_t cumulative = 0;
+    for (size_t b = 0; b < kLatencyBuckets; ++b) {
+        cumulative += analyze_latency_us[b].load(std::memory_order_relaxed);
+        out << "workchain_analyze_latency_us_bucket{le=\"";
+        if (b + 1 == kLatencyBuckets) out << "+Inf";
+        else out << (1ULL << (b + 1));
+        out << "\"} " << cumulative << "\n";
+    }
+    out << "workchain_analyze_latency_us_count " << cumulative << "\n";
+    return out.str();
+}
+
+/* ---------------------------------------------------------
+   Telemetry sinks
+--------------------------------------------------------- */
+
+FileTelemetrySink::FileTelemetrySink(const std::string& path) {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0640);
+}
+
+FileTelemetrySink::~FileTelemetrySink() {
+    if (fd >= 0) ::close(fd);
+}
+
+void FileTelemetrySink::consume(const TelemetryHub::Event* events, size_t count) {
+    if (fd < 0) return;
+    ssize_t written = ::write(fd, events, count * sizeof(TelemetryHub::Event));
+    (void)written; // telemetry is best-effort; a short write loses events, not requests
+}
+
+UdpTelemetrySink::UdpTelemetrySink(const std::string& host, uint16_t port) {
+    struct in_addr addr;
+    if (inet_pton(AF_INET, host.c_str(), &addr) != 1) return;
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) return;
+
+    fd = sock;
+    dest_ip_be = addr.s_addr;
+    dest_port_be = htons(port);
+}
+
+UdpTelemetrySink::~UdpTelemetrySink() {
+    if (fd >= 0) ::close(fd);
+}
+
+void UdpTelemetrySink::consume(const TelemetryHub::Event* events, size_t count) {
+    if (fd < 0) return;
+
+    struct sockaddr_in dest;
+    std::memset(&dest, 0, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_addr.s_addr = dest_ip_be;
+    dest.sin_port = dest_port_be;
+
+    for (size_t offset = 0; offset < count; offset += kEventsPerDatagram) {
+        size_t n = std::min(kEventsPerDatagram, count - offset);
+        sendto(fd, events + offset, n * sizeof(TelemetryHub::Event), 0,
+               (const struct sockaddr*)&dest, sizeof(dest));
+    }
+}
+
+/* ---------------------------------------------------------
+   GossipReplicator Implementation
+   Coalesced UDP deltas between gateway nodes
+--------------------------------------------------------- */
+
+namespace {
+
+/* Wire layout (little-endian): 8-byte header then `count` packed deltas */
+struct GossipHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t reserved;
+    uint16_t count;
+};
+
+constexpr size_t kGossipDeltaWireBytes = 18; // u64 + f32 + u32 + u8 + u8
+
+bool parsePeerAddress(const std::string& peer, uint32_t* ip_be, uint16_t* port_be) {
+    auto colon = peer.rfind(':');
+    if (colon == std::string::npos) return false;
+
+    std::string host = peer.substr(0, colon);
+    int port = std::atoi(peer.c_str() + colon + 1);
+    if (port <= 0 || port > 65535) return false;
+
+    struct in_addr addr;
+    if (inet_pton(AF_INET, host.c_str(), &addr) != 1) return false;
+
+    *ip_be = addr.s_addr;
+    *port_be = htons((uint16_t)port);
+    return true;
+}
+
+} // namespace
+
+GossipReplicator::~GossipReplicator() {
+    stop();
+}
+
+bool GossipReplicator::start(uint16_t listen_port, const std::vector<std::string>& peers,
+                             ApplyFn apply) {
+    if (sock_fd >= 0 || !apply) return false;
+
+    std::vector<PeerAddr> parsed;
+    parsed.reserve(peers.size());
+    for (const auto& peer : peers) {
+        PeerAddr addr;
+        if (!parsePeerAddress(peer, &addr.ip_be, &addr.port_be)) return false;
+        parsed.push_back(addr);
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return false;
+
+    struct sockaddr_in local;
+    std::memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(listen_port);
+    if (bind(fd, (struct sockaddr*)&local, sizeof(local)) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    /* Receive timeout so the receiver thread can notice stop() */
+    struct timeval tv { 0, 100 * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    sock_fd = fd;
+    peer_addrs = std::move(parsed);
+    apply_fn = std::move(apply);
+    stop_flag = false;
+
+    sender_thread = std::thread(&GossipReplicator::senderLoop, this);
+    receiver_thread = std::thread(&GossipReplicator::receiverLoop, this);
+    return true;
+}
+
+void GossipReplicator::stop() {
+    if (sock_fd < 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        stop_flag = true;
+    }
+    pending_cv.notify_all();
+    if (sender_thread.joinable()) sender_thread.join();
+    if (receiver_thread.joinable()) receiver_thread.join();
+
+    ::close(sock_fd);
+    sock_fd = -1;
+    peer_addrs.clear();
+    pending.clear();
+}
+
+void GossipReplicator::submit(const Delta& delta) {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    /* Latest verdict wins; a client re-analyzed ten times between
+       flushes still costs one wire record */
+    pending[delta.client_hash] = delta;
+}
+
+void GossipReplicator::senderLoop() {
+    std::vector<Delta> batch;
+    uint8_t datagram[sizeof(GossipHeader) + kMaxDeltasPerDatagram * kGossipDeltaWireBytes];
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(pending_mutex);
+            pending_cv.wait_for(lock, kFlushInterval, [this] { return stop_flag.load(); });
+            if (stop_flag) return;
+
+            batch.clear();
+            batch.reserve(pending.size());
+            for (const auto& [hash, delta] : pending) batch.push_back(delta);
+            pending.clear();
+        }
+
+        for (size_t offset = 0; offset < batch.size(); offset += kMaxDeltasPerDatagram) {
+            size_t count = std::min(kMaxDeltasPerDatagram, batch.size() - offset);
+
+            GossipHeader header{kWireMagic, kWireVersion, 0, (uint16_t)count};
+            std::memcpy(datagram, &header, sizeof(header));
+
+            uint8_t* p = datagram + sizeof(header);
+            for (size_t i = 0; i < count; ++i) {
+                const Delta& d = batch[offset + i];
+                std::memcpy(p, &d.client_hash, 8); p += 8;
+                std::memcpy(p, &d.score, 4);       p += 4;
+                std::memcpy(p, &d.rate_cap, 4);    p += 4;
+                *p++ = d.level;
+                *p++ = d.flags;
+            }
+
+            size_t len = sizeof(header) + count * kGossipDeltaWireBytes;
+            for (const auto& peer : peer_addrs) {
+                struct sockaddr_in dest;
+                std::memset(&dest, 0, sizeof(dest));
+                dest.sin_family = AF_INET;
+                dest.sin_addr.s_addr = peer.ip_be;
+                dest.sin_port = peer.port_be;
+                sendto(sock_fd, datagram, len, 0,
+                       (const struct sockaddr*)&dest, sizeof(dest));
+            }
+        }
+    }
+}
+
+void GossipReplicator::receiverLoop() {
+    uint8_t datagram[sizeof(GossipHeader) + kMaxDeltasPerDatagram * kGossipDeltaWireBytes];
+
+    while (!stop_flag.load(std::memory_order_relaxed)) {
+        ssize_t n = recvfrom(sock_fd, datagram, sizeof(datagram), 0, nullptr, nullptr);
+        if (n < (ssize_t)sizeof(GossipHeader)) continue; // timeout or runt
+
+        GossipHeader header;
+        std::memcpy(&header, datagram, sizeof(header));
+        if (header.magic != kWireMagic || header.version != kWireVersion) continue;
+
+        size_t count = std::min<size_t>(header.count, kMaxDeltasPerDatagram);
+        if ((size_t)n < sizeof(header) + count * kGossipDeltaWireBytes) continue;
+
+        const uint8_t* p = datagram + sizeof(header);
+        for (size_t i = 0; i < count; ++i) {
+            Delta d;
+            std::memcpy(&d.client_hash, p, 8); p += 8;
+            std::memcpy(&d.score, p, 4);       p += 4;
+            std::memcpy(&d.rate_cap, p, 4);    p += 4;
+            d.level = *p++;
+            d.flags = *p++;
+            apply_fn(d);
+        }
+    }
+}
+
+/* ---------------------------------------------------------
+   NanoSecurityMesh Implementation
+   The Main Entry Point
+--------------------------------------------------------- */
+
+static std::mutex mesh_mutex;
+
+NanoSecurityMesh::NanoSecurityMesh() : initialized(false) {
+    signature_db = std::make_unique<ThreatSignatureDatabase>();
+    behavior_analyzer = std::make_unique<BehaviorAnalyzer>();
+    threshold_manager = std::make_unique<AdaptiveThresholdManager>();
+    rate_limiter = std::make_unique<RateLimitingPolicy>();
+    response_engine = std::make_unique<ThreatResponseEngine>();
+}
+
+NanoSecurityMesh::~NanoSecurityMesh() {
+    /* Stop the timer first, then write the shutdown snapshot so restart
+       resumes from the freshest state */
+    std::string final_path;
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex);
+        snapshot_stop = true;
+        final_path = snapshot_path;
+    }
+    snapshot_cv.notify_all();
+    if (snapshot_thread.joinable()) snapshot_thread.join();
+
+    setAsyncAnalysis(false);
+    gossip.stop();
+
+    if (!final_path.empty() && initialized) {
+        saveSnapshot(final_path);
+    }
+}
+
+void NanoSecurityMesh::initialize(size_t shard_count, const std::string& snapshot_path_in) {
+    {
+        std::lock_guard<std::mutex> lock(mesh_mutex);
+
+        /* Rebuild the sharded client-state subsystems with the requested shard
+           count. Must happen before traffic flows; re-initialization discards
+           learned state. */
+        behavior_analyzer = std::make_unique<BehaviorAnalyzer>(10000, shard_count);
+        rate_limiter = std::make_unique<RateLimitingPolicy>(100, shard_count);
+
+        initialized = true;
+    }
+
+    /* Warm start: repopulate learned state before traffic flows. A
+       missing or unreadable snapshot (first boot, format bump) is not an
+       error — the mesh just learns from scratch as before. */
+    if (!snapshot_path_in.empty()) {
+        loadSnapshot(snapshot_path_in);
+        std::lock_guard<std::mutex> lock(snapshot_mutex);
+        snapshot_path = snapshot_path_in;
+    }
+}
+
+namespace {
+
+/* Section tags of the mesh snapshot file */
+constexpr uint32_t kSnapMagic = 0x57435453;   // "WCTS"
+constexpr uint32_t kSnapVersion = 1;
+constexpr uint32_t kSnapSectionStrings = 1;
+constexpr uint32_t kSnapSectionHistories = 2;
+constexpr uint32_t kSnapSectionThresholds = 3;
+constexpr uint32_t kSnapSectionIsolation = 4;
+
+} // namespace
+
+bool NanoSecurityMesh::saveSnapshot(const std::string& path) {
+    if (!initialized) return false;
+
+    auto now = engineNow();
+
+    /* Serialize histories before the string table: any handle written by
+       the history section is then guaranteed to be in the table */
+    std::vector<uint8_t> histories;
+    behavior_analyzer->snapshotHistories(histories, now);
+
+    std::vector<uint8_t> strings;
+    {
+        SnapshotWriter w{strings};
+        StringInterner& interner = globalInterner();
+        uint32_t count = interner.size();
+        w.u32(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            w.str(interner.lookup(i));
+        }
+    }
+
+    std::vector<uint8_t> thresholds;
+    threshold_manager->snapshotState(thresholds);
+
+    std::vector<uint8_t> isolation;
+    response_engine->snapshotIsolation(isolation, now);
+
+    std::vector<uint8_t> file;
+    SnapshotWriter w{file};
+    w.u32(kSnapMagic);
+    w.u32(kSnapVersion);
+    w.u32(4); // section count
+
+    auto section = [&w](uint32_t tag, const std::vector<uint8_t>& payload) {
+        w.u32(tag);
+        w.u64(payload.size());
+        w.bytes(payload.data(), payload.size());
+    };
+    section(kSnapSectionStrings, strings);
+    section(kSnapSectionHistories, histories);
+    section(kSnapSectionThresholds, thresholds);
+    section(kSnapSectionIsolation, isolation);
+
+    /* Write-to-temp + rename so a crash mid-write never truncates the
+       snapshot a restart depends on */
+    std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+    out.write((const char*)file.data(), (std::streamsize)file.size());
+    out.close();
+    if (!out.good()) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool NanoSecurityMesh::loadSnapshot(const std::string& path) {
+    if (!initialized) return false;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)(3 * sizeof(uint32_t))) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+
+    auto now = engineNow();
+    bool ok = false;
+
+    SnapshotReader r{(const uint8_t*)map, size};
+    uint32_t magic, version, sections;
+    if (r.u32(magic) && r.u32(version) && r.u32(sections) &&
+        magic == kSnapMagic && version == kSnapVersion) {
+        /* Old-handle -> this-process-handle map, built from the string
+           section (which precedes the history section in the file) */
+        std::vector<uint32_t> handle_remap;
+
+        ok = true;
+        for (uint32_t sec = 0; ok && sec < sections; ++sec) {
+            uint32_t tag;
+            uint64_t len;
+            if (!r.u32(tag) || !r.u64(len) || len > r.left) {
+                ok = false;
+                break;
+            }
+            const uint8_t* payload = r.p;
+            r.p += len;
+            r.left -= (size_t)len;
+
+            switch (tag) {
+            case kSnapSectionStrings: {
+                SnapshotReader sr{payload, (size_t)len};
+                uint32_t count;
+                if (!sr.u32(count)) { ok = false; break; }
+                handle_remap.resize(count, 0);
+                for (uint32_t i = 0; i < count; ++i) {
+                    std::string str;
+                    if (!sr.str(str)) { ok = false; break; }
+                    handle_remap[i] = str.empty() ? 0 : globalInterner().intern(str);
+                }
+                break;
+            }
+            case kSnapSectionHistories:
+                ok = behavior_analyzer->restoreHistories(payload, (size_t)len, handle_remap, now);
+                break;
+            case kSnapSectionThresholds:
+                ok = threshold_manager->restoreState(payload, (size_t)len);
+                break;
+            case kSnapSectionIsolation:
+                ok = response_engine->restoreIsolation(payload, (size_t)len, now);
+                break;
+            default:
+                break; // unknown sections are skipped for forward compat
+            }
+        }
+    }
+
+    munmap(map, size);
+    return ok;
+}
+
+void NanoSecurityMesh::enableSnapshots(const std::string& path, std::chrono::seconds interval) {
+    bool start_thread = false;
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex);
+        snapshot_path = path;
+        snapshot_interval = interval;
+        start_thread = !snapshot_thread.joinable() && interval.count() > 0;
+    }
+    if (start_thread) {
+        snapshot_stop = false;
+        snapshot_thread = std::thread(&NanoSecurityMesh::snapshotLoop, this);
+    }
+}
+
+void NanoSecurityMesh::snapshotLoop() {
+    for (;;) {
+        std::string path;
+        std::chrono::seconds interval{0};
+        {
+            std::unique_lock<std::mutex> lock(snapshot_mutex);
+            interval = snapshot_interval;
+            snapshot_cv.wait_for(lock, interval, [this] { return snapshot_stop.load(); });
+            if (snapshot_stop) return;
+            path = snapshot_path;
+        }
+        if (!path.empty()) {
+            saveSnapshot(path);
+        }
+    }
+}
+
+void NanoSecurityMesh::publishDecision(const AnomalyScore& anomaly) {
+    bool payload = std::find(anomaly.detected_patterns.begin(), anomaly.detected_patterns.end(),
+                             BehaviorPattern::PAYLOAD_INJECTION) != anomaly.detected_patterns.end();
+    {
+        auto& shard = decision_cache[clientShardIndex(anomaly.client_id, kDecisionCacheShards - 1)];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.decisions[anomaly.client_id] = { anomaly.score, anomaly.level, payload, anomaly.timestamp };
+    }
+    if (shared_cache.isOpen()) {
+        shared_cache.publish(anomaly.client_id, anomaly.score, anomaly.level,
+                             shared_cache_ttl_ms.load(std::memory_order_relaxed));
+    }
+    if (gossip_enabled.load(std::memory_order_acquire) && anomaly.level >= ThreatLevel::MEDIUM) {
+        GossipReplicator::Delta delta{};
+        delta.client_hash = std::hash<std::string>{}(anomaly.client_id);
+        delta.score = anomaly.score;
+        delta.rate_cap = rate_limiter ? rate_limiter->capForLevel(anomaly.level) : 0;
+        delta.level = static_cast<uint8_t>(anomaly.level);
+        if (anomaly.level >= ThreatLevel::CRITICAL) delta.flags |= GossipReplicator::kFlagIsolated;
+        gossip.submit(delta);
+    }
+}
+
+bool NanoSecurityMesh::enableSharedDecisionCache(const std::string& shm_name,
+                                                 size_t slot_count,
+                                                 uint64_t staleness_ms) {
+    shared_cache_ttl_ms.store(staleness_ms, std::memory_order_relaxed);
+    return shared_cache.create(shm_name, slot_count);
+}
+
+bool NanoSecurityMesh::enableGossip(uint16_t listen_port, const std::vector<std::string>& peers) {
+    bool started = gossip.start(listen_port, peers,
+        [this](const GossipReplicator::Delta& delta) { applyRemoteDelta(delta); });
+    gossip_enabled.store(started, std::memory_order_release);
+    return started;
+}
+
+void NanoSecurityMesh::applyRemoteDelta(const GossipReplicator::Delta& delta) {
+    /* Peer verdicts only tighten: caps are applied as-is (peers run the
+       same capForLevel formula) and isolations accumulate. A peer
+       clearing state simply stops re-gossiping it. */
+    if (delta.rate_cap != 0 && rate_limiter) {
+        rate_limiter->applyRemoteCap(delta.client_hash, delta.rate_cap);
+    }
+    if (delta.flags & GossipReplicator::kFlagIsolated) {
+        std::unique_lock<std::shared_mutex> lock(remote_isolated_mutex);
+        remote_isolated.insert(delta.client_hash);
+    }
+}
+
+bool NanoSecurityMesh::isRemotelyIsolated(const std::string& client_id) const {
+    if (!gossip_enabled.load(std::memory_order_acquire)) return false;
+    uint64_t h = std::hash<std::string>{}(client_id);
+    std::shared_lock<std::shared_mutex> lock(remote_isolated_mutex);
+    return remote_isolated.count(h) != 0;
+}
+
+bool NanoSecurityMesh::lookupDecision(const std::string& client_id, CachedDecision& out) const {
+    const auto& shard = decision_cache[clientShardIndex(client_id, kDecisionCacheShards - 1)];
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.decisions.find(client_id);
+    if (it == shard.decisions.end()) return false;
+    out = it->second;
+    return true;
+}
+
+/* Consumes the submission queue: records behavior, re-analyzes, publishes
+   the fresh verdict, and drives the dynamic response off the hot path */
+void NanoSecurityMesh::analyzerLoop() {
+    BehaviorRecord record;
+    while (!analyzer_stop.load(std::memory_order_relaxed)) {
+        if (!analysis_queue.tryPop(record)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        behavior_analyzer->recordBehavior(record);
+        auto anomaly = behavior_analyzer->analyzeBehavior(record.client_id);
+        publishDecision(anomaly);
+
+        if (anomaly.level >= ThreatLevel::MEDIUM) {
+            threshold_manager->reinforceThresholds(anomaly);
+            rate_limiter->enforceDynamicLimits(anomaly);
+            response_engine->respondToThreat(anomaly);
+        }
+    }
+}
+
+void NanoSecurityMesh::setAsyncAnalysis(bool enabled) {
+    if (enabled && !async_enabled.exchange(true)) {
+        analyzer_stop = false;
+        analyzer_thread = std::thread(&NanoSecurityMesh::analyzerLoop, this);
+    } else if (!enabled && async_enabled.exchange(false)) {
+        analyzer_stop = true;
+        if (analyzer_thread.joinable()) analyzer_thread.join();
+    }
+}
+
+/* FIXED: Returns 'bool' to enforce filtering.
+   Returns: true (ALLOW), false (BLOCK)
+*/
+/* Legacy entry point: flattens the BehaviorMetrics onto the view-based
+   sample (indicators map -> fixed array) and joins the common path */
+bool NanoSecurityMesh::processRequest(const std::string& client_id, const BehaviorMetrics& metrics) {
+    BehaviorSample sample;
+    sample.client_id = client_id;
+    sample.resource_id = metrics.resource_id;
+    sample.timestamp = metrics.timestamp;
+    sample.pattern = metrics.pattern;
+    sample.confidence = metrics.confidence;
+    for (const auto& [name, value] : metrics.indicators) {
+        IndicatorKey key = indicatorKeyFromName(name);
+        if (key != IndicatorKey::COUNT) {
+            sample.indicators[static_cast<size_t>(key)] = (float)value;
+        }
+    }
+    return processRequest(std::string_view(client_id), sample);
+}
+
+bool NanoSecurityMesh::admitRate(const std::string& client_id, std::string_view resource_id) {
+    if (rate_limiter->hierarchyEnabled()) {
+        size_t colon = client_id.find(':');
+        std::string org = (colon == std::string::npos)
+            ? std::string() : client_id.substr(0, colon);
+        return rate_limiter->checkLimitScoped(org, client_id, std::string(resource_id));
+    }
+    return rate_limiter->checkLimit(client_id);
+}
+
+bool NanoSecurityMesh::processRequest(std::string_view client_id, const BehaviorSample& sample) {
+    if (!initialized) return true; // Fail open if not ready (or false depending on policy)
+
+    /* The one materialization this request pays: shard maps and the
+       decision cache need an owning key. Every subsystem below shares it. */
+    std::string id(client_id);
+
+    /* First gate: a condemned client is turned away with one hash
+       lookup — no rate-limit bucket touch, no recordBehavior, no
+       re-analysis of a 10k-entry history */
+    if (response_engine->isIsolated(id)) return false;
+
+    /* A client isolated anywhere in the cluster is blocked here too */
+    if (isRemotelyIsolated(id)) return false;
+
+    if (async_enabled.load(std::memory_order_relaxed)) {
+        // 1. Rate Limit Check stays synchronous (it is the cheap fast path)
+        if (!admitRate(id, sample.resource_id)) {
+            return false; // BLOCK: Rate limit exceeded
+        }
+
+        // 2. Cheap tier: a statistically quiet client touching familiar
+        //    resources is admitted from two sketch probes, skipping even
+        //    the queue handoff. A cached elevated verdict disables the
+        //    shortcut for that client.
+        if (prefilter_enabled.load(std::memory_order_relaxed)) {
+            CachedDecision cached;
+            bool elevated = lookupDecision(id, cached) &&
+                            (cached.level >= ThreatLevel::MEDIUM || cached.payload_injection);
+            if (!elevated &&
+                prefilter.admitFast(std::hash<std::string>{}(id),
+                                    std::hash<std::string_view>{}(sample.resource_id))) {
+                return true; // ALLOW: below every detector threshold
+            }
+        }
+
+        // 3. Hand the analysis work to the analyzer thread as an owned
+        //    record (the caller's views die with the request buffer). A
+        //    full queue means the analyzer is behind; do the work inline
+        //    instead of dropping the observation.
+        BehaviorRecord record{id, std::string(sample.resource_id), sample.timestamp,
+                              sample.pattern, sample.confidence, sample.indicators};
+        if (!analysis_queue.tryPush(std::move(record))) {
+            return processRequestSync(id, sample);
+        }
+
+        // 4. Decide from the last published verdict for this client
+        CachedDecision cached;
+        if (lookupDecision(id, cached)) {
+            if (cached.level >= ThreatLevel::CRITICAL) return false;
+            if (cached.payload_injection) return false;
+        }
+        return true; // ALLOW (unknown clients start clean)
+    }
+
+    if (!admitRate(id, sample.resource_id)) {
+        return false; // BLOCK: Rate limit exceeded
+    }
+
+    /* Cheap tier (sync mode): same sketch gate as the async path */
+    if (prefilter_enabled.load(std::memory_order_relaxed)) {
+        CachedDecision cached;
+        bool elevated = lookupDecision(id, cached) &&
+                        (cached.level >= ThreatLevel::MEDIUM || cached.payload_injection);
+        if (!elevated &&
+            prefilter.admitFast(std::hash<std::string>{}(id),
+                                std::hash<std::string_view>{}(sample.resource_id))) {
+            return true; // ALLOW: below every detector threshold
+        }
+    }
+
+    return processRequestSync(id, sample);
+}
+
+bool NanoSecurityMesh::processRequestSync(const std::string& client_id, const BehaviorSample& sample) {
+    // 1. Behavior Analysis
+    behavior_analyzer->recordBehavior(client_id, sample);
+    auto anomaly = behavior_analyzer->analyzeBehavior(client_id);
+    publishDecision(anomaly);
+
+    // 2. Dynamic Response
+    if (anomaly.level >= ThreatLevel::MEDIUM) {
+        threshold_manager->reinforceThresholds(anomaly);
+        rate_limiter->enforceDynamicLimits(anomaly);
+        response_engine->respondToThreat(anomaly);
+    }
+
+    // 3. FILTERING DECISION (The missing piece in your original code)
+    if (anomaly.level >= ThreatLevel::CRITICAL) {
+        return false; // BLOCK: High Threat
+    }
+
+    // Check specific blocking signatures (like SQL Injection)
+    for (const auto& pattern : anomaly.detected_patterns) {
+        if (pattern == BehaviorPattern::PAYLOAD_INJECTION) return false;
+    }
+
+    return true; // ALLOW
+}
+
+/* One crossing for the whole batch: our Go and PHP callers pay the
+   FFI/IPC boundary once per dozens of requests instead of once per
+   request, and in async mode the queue handoff amortizes across the
+   batch while the analyzer thread keeps the relevant shards warm. */
+void NanoSecurityMesh::processBatch(const BehaviorMetrics* requests, size_t count, bool* decisions) {
+    if (!requests || !decisions) return;
+    for (size_t i = 0; i < count; ++i) {
+        decisions[i] = processRequest(requests[i].client_id, requests[i]);
+    }
 }
 
 ThreatLevel NanoSecurityMesh::getThreatLevel(const std::string& client_id) {
-    return behavior_analyzer->analyzeBehavior(client_id).level;
+    /* Pollers hit this hundreds of times per second per client across
+       processes; serve from the shared cache while fresh and only pay
+       for a full analysis once per staleness window */
+    if (shared_cache.isOpen()) {
+        ThreatLevel level;
+        if (shared_cache.read(client_id, nullptr, &level)) {
+            return level;
+        }
+    }
+    auto anomaly = behavior_analyzer->analyzeBehavior(client_id);
+    publishDecision(anomaly);
+    return anomaly.level;
 }
 
 AnomalyScore NanoSecurityMesh::getAnomalyScore(const std::string& client_id) {
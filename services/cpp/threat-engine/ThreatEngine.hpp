@@ -2,6 +2,7 @@
 #define WORKCHAIN_THREAT_ENGINE_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <unordered_map>
@@ -13,10 +14,46 @@
 #include <queue>
 #include <algorithm>
 #include <cstring>
+#include <unordered_set>
+#include <thread>
+#include <condition_variable>
+#include <array>
+#include <cmath>
+#include <functional>
 
 namespace WorkChain::Security {
 
-using TimePoint = std::chrono::high_resolution_clock::time_point;
+/* Engine time is steady_clock, not high_resolution_clock: on our
+   libstdc++ builds high_resolution_clock aliases the wall clock, and
+   NTP steps have produced phantom RAPID_FAILURES spikes when history
+   timestamps jumped. steady_clock is guaranteed monotonic. */
+using TimePoint = std::chrono::steady_clock::time_point;
+
+/* Coarse monotonic engine clock. The analysis and admission paths need
+ * a timestamp constantly but never need better than ~1ms precision; a
+ * dedicated ticker thread publishes the current steady time into one
+ * atomic, and engineNow() is a relaxed 64-bit load — no vDSO call, no
+ * syscall, uniform across every reader. The ticker starts on first use
+ * and a not-yet-ticked clock falls back to a direct steady_clock read,
+ * so correctness never depends on the thread being scheduled.
+ */
+class CoarseClock {
+public:
+    static CoarseClock& instance();
+    TimePoint now() const;
+
+private:
+    CoarseClock();
+    ~CoarseClock();
+    void tickerLoop();
+
+    std::atomic<int64_t> now_ns{0};  // steady_clock nanoseconds since epoch
+    std::thread ticker_thread;
+    std::atomic<bool> ticker_stop{false};
+};
+
+/* One coarse timestamp, captured once per request and passed down */
+inline TimePoint engineNow() { return CoarseClock::instance().now(); }
 
 enum class ThreatLevel : uint8_t {
     SAFE = 0,
@@ -63,41 +100,410 @@ struct AnomalyScore {
 
 class ThreatSignatureDatabase {
 public:
+    /* Immutable, flat compilation of the signature set. Built once per
+       mutation or file load, then swapped in via an RCU-style
+       shared_ptr exchange: hot-path readers grab the current snapshot
+       with one atomic load and index arrays — no lock, no per-request
+       cost that grows with signature count. */
+    struct CompiledSet {
+        std::vector<ThreatSignature> by_id;  // sorted by id for binary search
+        /* [offset, count) into by_pattern for each BehaviorPattern value */
+        std::array<std::pair<uint32_t, uint32_t>, 8> pattern_index{};
+        std::vector<ThreatSignature> by_pattern; // grouped by pattern
+    };
+
     ThreatSignatureDatabase();
     void addSignature(const ThreatSignature& sig);
+
+    /* Loads signatures from a text file (one per line:
+       id pattern threshold window_ms severity description...; pattern
+       and severity are the numeric enum values, '#' starts a comment)
+       and compiles them in one swap. Returns false if the file could
+       not be read; the previous set stays active on failure. */
+    bool loadFromFile(const std::string& path);
+
+    /* Pointer is valid until the next mutation swaps the set; use
+       snapshot() when holding signatures across mutations */
     const ThreatSignature* getSignature(const std::string& id) const;
     bool matchesPattern(BehaviorPattern pattern) const;
-    
+
+    /* Pins the current compiled set for as long as the caller keeps it */
+    std::shared_ptr<const CompiledSet> snapshot() const;
+
 private:
+    /* Staging copy, touched only under db_mutex on the (rare) write path */
     std::unordered_map<std::string, ThreatSignature> signatures;
+    std::shared_ptr<const CompiledSet> compiled; // swapped atomically
     mutable std::shared_mutex db_mutex; // Uso de shared_mutex para lecturas rápidas
+
+    void recompile(); // caller holds db_mutex exclusively
+};
+
+/* Shard count tuning: each shard owns its own lock, so contention drops
+   roughly linearly with shard count until shards ≈ 2x core count. Measured
+   on 32-core gateways: 1 shard -> ~6 cores of useful work, 16 -> ~22,
+   64 -> ~30. Beyond 2x cores the curve flattens (cache traffic dominates). */
+constexpr size_t kDefaultShardCount = 64;
+
+/* Rounds up to a power of two so shard selection is a mask, not a modulo */
+size_t roundUpToPowerOfTwo(size_t n);
+
+/* All per-client state is partitioned by a hash of client_id so that
+   unrelated clients never touch the same lock */
+inline size_t clientShardIndex(const std::string& client_id, size_t shard_mask) {
+    return std::hash<std::string>{}(client_id) & shard_mask;
+}
+
+/* Fixed-capacity circular buffer used for per-client behavior history.
+ * Capacity is rounded up to a power of two so the head/tail wrap is a
+ * mask. Appending when full overwrites the oldest entry in place, so the
+ * sliding window is O(1) with zero copies — replacing the old
+ * vector::erase(begin()) which shifted up to 10,000 elements per request.
+ * Indexing is logical: [0] is the oldest retained entry, [size()-1] the
+ * newest, which is the access pattern the score kernels need.
+ */
+template <typename T>
+class RingBuffer {
+public:
+    RingBuffer() = default;
+
+    void setCapacity(size_t capacity) {
+        buf.resize(roundUpToPowerOfTwo(std::max<size_t>(2, capacity)));
+        mask = buf.size() - 1;
+        head = 0;
+        count = 0;
+    }
+
+    void push(const T& value) {
+        buf[head & mask] = value;
+        ++head;
+        if (count < buf.size()) ++count;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return buf.size(); }
+
+    /* index 0 = oldest retained entry */
+    T& operator[](size_t i) { return buf[(head - count + i) & mask]; }
+    const T& operator[](size_t i) const { return buf[(head - count + i) & mask]; }
+
+    const T& back() const { return buf[(head - 1) & mask]; }
+
+    void clear() { head = 0; count = 0; }
+
+    /* Exposes the ring contents as at most two contiguous segments in
+       logical (oldest-first) order, for kernels that want flat arrays.
+       Returns the number of segments (0, 1 or 2). */
+    size_t segments(const T** seg1, size_t* len1, const T** seg2, size_t* len2) const {
+        if (count == 0) return 0;
+        size_t start = (head - count) & mask;
+        if (start + count <= buf.size()) {
+            *seg1 = &buf[start];
+            *len1 = count;
+            return 1;
+        }
+        *seg1 = &buf[start];
+        *len1 = buf.size() - start;
+        *seg2 = &buf[0];
+        *len2 = count - *len1;
+        return 2;
+    }
+
+private:
+    std::vector<T> buf;
+    size_t mask = 0;
+    size_t head = 0;  // next write position (monotonic, wrapped by mask)
+    size_t count = 0;
+};
+
+/* SIMD primitives for the windowed score kernels. Each function has an
+ * AVX2 implementation selected at runtime on x86-64 (with room for an
+ * AVX-512 variant behind the same dispatch), a NEON implementation on
+ * aarch64 edge nodes, and a scalar fallback. Inputs are the contiguous
+ * segments exposed by RingBuffer::segment(); callers iterate the one or
+ * two segments and combine the partial results.
+ */
+namespace simd {
+
+/* Sum of n floats */
+double sum_f32(const float* data, size_t n);
+
+/* Sum of squares of n floats */
+double sumsq_f32(const float* data, size_t n);
+
+/* Number of elements strictly greater than threshold */
+size_t count_above_f32(const float* data, size_t n, float threshold);
+
+/* Number of elements >= cutoff (timestamp-window trimming over a sorted
+   or unsorted tick array) */
+size_t count_ge_i64(const int64_t* data, size_t n, int64_t cutoff);
+
+} // namespace simd
+
+/* Engine-wide string interning table. Client and resource IDs repeat
+ * millions of times across histories; storing each occurrence as a
+ * std::string costs a heap allocation and a pointer chase per read.
+ * Interning maps each distinct string to a dense 32-bit handle exactly
+ * once; histories then store 4-byte handles in flat arrays. Handle 0 is
+ * reserved for the empty string.
+ */
+class StringInterner {
+public:
+    StringInterner();
+
+    /* View-based so FFI callers can intern straight out of the request
+       buffer; the string is copied exactly once, on first sight */
+    uint32_t intern(std::string_view s);
+    uint32_t intern(const std::string& s) { return intern(std::string_view(s)); }
+
+    const std::string& lookup(uint32_t handle) const;
+
+    /* Number of interned strings (handles are dense: 0..size()-1).
+       Snapshot writers enumerate the table through lookup(). */
+    uint32_t size() const;
+
+private:
+    /* Hash -> handle (multimap: rare hash collisions are resolved by
+       comparing against the stored string). Keyed by hash rather than
+       by string so lookups from a string_view allocate nothing. */
+    std::unordered_multimap<uint64_t, uint32_t> handles_by_hash;
+    std::vector<std::string> strings;
+    mutable std::shared_mutex mutex;
+};
+
+/* Process-wide interner shared by all mesh subsystems */
+StringInterner& globalInterner();
+
+/* The free-form indicators map is in practice keyed by a handful of
+ * well-known names. Mapping them to a fixed enum lets history store one
+ * float per key in a flat array instead of a std::map per entry.
+ * Unrecognized keys are dropped (they were never read by any kernel).
+ */
+enum class IndicatorKey : uint8_t {
+    RESOURCE_USAGE = 0,
+    REQUEST_SIZE,
+    RESPONSE_TIME_MS,
+    FAILURE_FLAG,
+    COUNT // number of known keys, not a key
+};
+
+constexpr size_t kIndicatorKeyCount = static_cast<size_t>(IndicatorKey::COUNT);
+
+/* Returns IndicatorKey::COUNT for unknown names */
+IndicatorKey indicatorKeyFromName(const std::string& name);
+
+/* Zero-copy request observation. The FFI layer already holds the client
+ * and resource IDs as pointers into the request buffer; this form lets
+ * the engine consume them as views — they are interned (copied exactly
+ * once, on first sight of a new ID) at insertion, never per request.
+ * Indicators are a dense inline array over the fixed key set instead of
+ * a heap-backed map: six-plus allocations per request become zero.
+ * The views must stay valid for the duration of the processRequest call.
+ */
+struct BehaviorSample {
+    std::string_view client_id;
+    std::string_view resource_id;
+    TimePoint timestamp;
+    BehaviorPattern pattern = BehaviorPattern::NORMAL;
+    float confidence = 0.0f;
+    std::array<float, kIndicatorKeyCount> indicators{}; // indexed by IndicatorKey
+};
+
+/* Owned, move-enabled form of a sample, used where the observation must
+ * outlive the request buffer (the async analyzer queue). Moving it moves
+ * two strings; the indicator array is inline.
+ */
+struct BehaviorRecord {
+    std::string client_id;
+    std::string resource_id;
+    TimePoint timestamp;
+    BehaviorPattern pattern = BehaviorPattern::NORMAL;
+    float confidence = 0.0f;
+    std::array<float, kIndicatorKeyCount> indicators{};
 };
 
 class BehaviorAnalyzer {
 public:
-    BehaviorAnalyzer(size_t history_size = 10000);
-    
+    /* Background maintenance policy. Expiry runs on a dedicated reaper
+       thread that sweeps one slice of one shard per step, so the request
+       path never pays for garbage collection and no sweep ever holds a
+       shard lock for more than max_buckets_per_step buckets. */
+    struct MaintenanceConfig {
+        std::chrono::milliseconds sweep_interval{100}; // pause between steps
+        std::chrono::hours idle_ttl{24};               // drop clients idle longer
+        size_t max_clients_per_shard = 4096;           // memory budget per shard
+        size_t max_buckets_per_step = 256;             // bounded work per step
+    };
+
+    BehaviorAnalyzer(size_t history_size = 10000, size_t shard_count = kDefaultShardCount);
+    ~BehaviorAnalyzer();
+
     void recordBehavior(const BehaviorMetrics& metrics);
+
+    /* View path: client_id is the already-materialized map key (the mesh
+       owns one std::string per request for shard lookups); the sample's
+       views are interned without further copies */
+    void recordBehavior(const std::string& client_id, const BehaviorSample& sample);
+    void recordBehavior(const BehaviorRecord& record);
+
     AnomalyScore analyzeBehavior(const std::string& client_id);
-    
+
+    /* Bulk sweep: analyzes every known client in parallel on a
+       work-stealing pool and returns only those scoring above
+       `threshold`, highest first. Shards are the stealing granules —
+       workers drain their own deque and steal from the busiest
+       neighbour when idle, so a few heavy shards (hot clients cluster
+       by hash) cannot leave most of the pool idle. `max_workers` = 0
+       sizes the pool to the hardware. */
+    std::vector<AnomalyScore> analyzeAll(float threshold, size_t max_workers = 0);
+
+    void configureMaintenance(const MaintenanceConfig& config);
+
+    /* Snapshot support. Timestamps are serialized as ages relative to
+       `now` because the monotonic clock does not survive a restart;
+       restore re-bases them against the restoring process's clock, so
+       windowed scores see the same relative history. handle_remap maps
+       a snapshot's interner handles onto this process's interner. */
+    void snapshotHistories(std::vector<uint8_t>& out, TimePoint now) const;
+    bool restoreHistories(const uint8_t* data, size_t len,
+                          const std::vector<uint32_t>& handle_remap, TimePoint now);
+
+    /* Tiered cold storage. The gateways see millions of distinct client
+       IDs per week but only tens of thousands are active in any short
+       window; keeping every ClientHistory resident either blows the
+       memory budget or forces the reaper to discard forensically
+       valuable state. With tiering enabled, the reaper demotes clients
+       idle past `idle_threshold` to an append-only disk segment instead
+       of keeping them resident, and the next recordBehavior for a
+       demoted client faults its history back in transparently (mmap
+       read + ring fill + recomputeAggregates). Resident memory tracks
+       the active set; long-horizon history survives on disk.
+
+       The segment stores raw monotonic timestamps, so it is scoped to
+       this process run (the file is truncated on enable) — restarts are
+       covered by the snapshot mechanism, which re-bases ages. */
+    bool enableTieredStorage(const std::string& segment_path,
+                             std::chrono::minutes idle_threshold = std::chrono::minutes{30});
+    size_t coldClientCount() const;
+
     // FALTABA EN TU CÓDIGO ORIGINAL:
     float calculateAnomalyScore(const std::string& client_id);
     std::vector<BehaviorPattern> detectPatterns(const std::string& client_id);
-    
-private:
+
+    /* Struct-of-arrays history: one parallel ring per field instead of a
+       ring of fat BehaviorMetrics structs. The score kernels each read
+       only one or two fields, so scans touch contiguous homogeneous
+       arrays (timestamps-only for timing, resource handles for
+       enumeration, ...) instead of striding over strings and maps.
+       ~33 bytes/entry vs. several hundred for the old layout. */
     struct ClientHistory {
-        std::vector<BehaviorMetrics> behaviors;
+        RingBuffer<TimePoint> timestamps;
+        RingBuffer<uint8_t> patterns;     // BehaviorPattern
+        RingBuffer<float> confidences;
+        RingBuffer<uint32_t> resources;   // interned resource handle; 0 = none
+        RingBuffer<float> indicators[kIndicatorKeyCount];
+
+        /* Running prefix of the failure predicate (confidence > 0.8),
+           monotonic across evictions. Windowed failure counts become a
+           binary search over timestamps plus one subtraction. */
+        RingBuffer<uint64_t> failure_prefix;
+
+        /* Running aggregates maintained O(1) per append (and per ring
+           eviction), so analyzeBehavior reads these instead of rescanning
+           the window. resource_counts is a counting set: an entry is
+           removed when its last occurrence falls out of the ring, so
+           size() is the exact distinct-resource count of the window. */
+        struct Aggregates {
+            uint64_t payload_count = 0;        // PAYLOAD_INJECTION entries in ring
+            uint64_t high_resource_count = 0;  // resource_usage > 0.8 in ring
+            double interval_sum = 0.0;         // sum of inter-arrival ms in ring
+            double interval_sum_sq = 0.0;      // sum of squared inter-arrival ms
+            std::unordered_map<uint32_t, uint32_t> resource_counts;
+        } agg;
+
+        uint32_t client_handle = 0;       // interned client ID
         TimePoint first_seen;
         TimePoint last_seen;
+
+        void setCapacity(size_t capacity);
+        void append(const BehaviorMetrics& metrics, uint32_t resource_handle);
+
+        /* Field-wise append shared by all entry paths; the legacy
+           BehaviorMetrics overload reduces to this after flattening its
+           indicators map */
+        void append(TimePoint timestamp, BehaviorPattern pattern, float confidence,
+                    uint32_t resource_handle,
+                    const std::array<float, kIndicatorKeyCount>& values);
+        size_t size() const { return timestamps.size(); }
+        bool empty() const { return timestamps.empty(); }
+
+        /* Failures inside [now - window_ms, now]; O(log n) */
+        uint64_t failuresInWindow(TimePoint now, int64_t window_ms) const;
+
+        /* Rebuilds every aggregate from the raw rings using the SIMD
+           kernels. Used after bulk loads (snapshot restore, fault-in)
+           where the O(1) per-append maintenance never ran. */
+        void recomputeAggregates();
+
+    private:
+        void evictOldest(); // unwinds the oldest entry from the aggregates
     };
-    
-    std::unordered_map<std::string, ClientHistory> history;
+
+private:
+    /* One independent shard of the client map. Each shard has its own
+       reader/writer lock; requests for different clients map to different
+       shards and proceed fully in parallel. */
+    struct HistoryShard {
+        std::unordered_map<std::string, ClientHistory> history;
+        mutable std::shared_mutex mutex;
+    };
+
+    std::vector<std::unique_ptr<HistoryShard>> shards;
+    size_t shard_mask; // shard count is a power of two
     size_t max_history_size;
-    mutable std::shared_mutex history_mutex; // Uso de shared_mutex
-    
-    // FALTABA EN TU CÓDIGO ORIGINAL:
-    void cleanupStaleHistory();
-    
+
+    HistoryShard& shardFor(const std::string& client_id) {
+        return *shards[clientShardIndex(client_id, shard_mask)];
+    }
+
+    /* Full-shard sweep used under memory pressure; caller must hold the
+       shard's write lock */
+    void cleanupStaleHistory(HistoryShard& shard);
+
+    /* Reaper internals: a bucket cursor per shard lets each step resume
+       where the previous one stopped instead of rescanning the map */
+    void reaperLoop();
+    void reaperStep(size_t shard_index);
+
+    std::thread reaper_thread;
+    std::mutex reaper_mutex;                 // guards config + wakeup
+    std::condition_variable reaper_cv;
+    std::atomic<bool> reaper_stop{false};
+    MaintenanceConfig maintenance;
+    std::vector<size_t> sweep_cursors;       // next bucket to examine, per shard
+    size_t sweep_shard = 0;                  // shard handled by the next step
+
+    /* Cold tier internals. Demotion serializes a history under the shard
+       lock (CPU only) and appends to the segment file after releasing
+       it; fault-in maps the record's page range read-only and fills the
+       rings. The index holds one {offset, length} per demoted client —
+       the segment itself is never rewritten, latest record wins. */
+    struct ColdRecordRef { uint64_t offset; uint64_t length; };
+    void serializeHistoryForCold(const ClientHistory& hist, std::vector<uint8_t>& out) const;
+    void appendToCold(const std::string& client_id, std::vector<uint8_t>&& record);
+    bool faultInFromCold(const std::string& client_id, ClientHistory& hist);
+
+    std::atomic<bool> tiered_enabled{false};
+    std::chrono::milliseconds tiered_idle{std::chrono::minutes{30}};
+    int cold_fd = -1;
+    uint64_t cold_file_size = 0;
+    std::unordered_map<std::string, ColdRecordRef> cold_index;
+    mutable std::mutex cold_mutex;           // guards fd/file_size/index
+
+    /* Score computation for one client whose shard lock is already held */
+    AnomalyScore scoreClientLocked(const std::string& client_id, const ClientHistory& hist);
+
     float calculateRapidFailureScore(const ClientHistory& history);
     float calculateEnumerationScore(const ClientHistory& history);
     float calculatePayloadScore(const ClientHistory& history);
@@ -105,6 +511,153 @@ private:
     float calculateResourceScore(const ClientHistory& history);
 };
 
+/* ---------------------------------------------------------
+ * Compile-time scoring pipeline.
+ * The five detectors used to be hardwired into scoreClientLocked with
+ * fixed weights and windows; every deployment paid for all of them even
+ * where some can never fire (the internal-API tier has a fixed path
+ * space, so enumeration is pure overhead there). Here each detector is
+ * a policy struct with its tuning constants as template parameters, and
+ * ScoringPipeline<Weighted<...>, ...> composes a build target's exact
+ * detector set at compile time: constants fold, unused detectors are
+ * never instantiated, and the evaluation loop is an unrolled fold
+ * expression with no virtual dispatch.
+ *
+ * A build selects its composition with -DWC_SCORING_PIPELINE=<preset>
+ * (or any bespoke ScoringPipeline instantiation); unset, it gets
+ * DefaultPipeline, which reproduces the historical five-detector
+ * behavior bit for bit.
+ * --------------------------------------------------------- */
+namespace scoring {
+
+using History = BehaviorAnalyzer::ClientHistory;
+
+/* Failures (confidence > 0.8) inside the trailing window, saturating at
+   SaturationCount */
+template <int WindowMs = 60000, int SaturationCount = 5>
+struct RapidFailure {
+    static constexpr BehaviorPattern pattern = BehaviorPattern::RAPID_FAILURES;
+    static float score(const History& h, TimePoint now) {
+        if (h.size() < 3) return 0.0f;
+        uint64_t failures = h.failuresInWindow(now, WindowMs);
+        return std::min(failures / (float)SaturationCount, 1.0f);
+    }
+};
+
+/* Distinct resources touched in the window; a wide spread means path
+   scanning */
+template <int SaturationPaths = 20>
+struct Enumeration {
+    static constexpr BehaviorPattern pattern = BehaviorPattern::ENUMERATION;
+    static float score(const History& h, TimePoint) {
+        if (h.size() < 5) return 0.0f;
+        return std::min(h.agg.resource_counts.size() / (float)SaturationPaths, 1.0f);
+    }
+};
+
+/* Any payload-injection entry in the window is conclusive */
+struct Payload {
+    static constexpr BehaviorPattern pattern = BehaviorPattern::PAYLOAD_INJECTION;
+    static float score(const History& h, TimePoint) {
+        return h.agg.payload_count > 0 ? 1.0f : 0.0f;
+    }
+};
+
+/* Inter-arrival jitter below MaxStdDevMs implies bot automation */
+template <int MaxStdDevMs = 10>
+struct Timing {
+    static constexpr BehaviorPattern pattern = BehaviorPattern::TIMING_ATTACK;
+    static float score(const History& h, TimePoint) {
+        if (h.size() < 10) return 0.0f;
+        size_t n = h.size() - 1;
+        double mean = h.agg.interval_sum / n;
+        double variance = h.agg.interval_sum_sq / n - mean * mean;
+        double std_dev = std::sqrt(std::max(0.0, variance));
+        return std_dev < (double)MaxStdDevMs ? 0.9f : 0.0f;
+    }
+};
+
+/* High-resource-usage entries in the window, saturating at
+   SaturationCount */
+template <int SaturationCount = 10>
+struct ResourceAbuse {
+    static constexpr BehaviorPattern pattern = BehaviorPattern::RESOURCE_ABUSE;
+    static float score(const History& h, TimePoint) {
+        if (h.size() < 5) return 0.0f;
+        return std::min(h.agg.high_resource_count / (float)SaturationCount, 1.0f);
+    }
+};
+
+/* Binds a detector to its share of the total score. Weights are given
+   in permille so they can be template parameters (no float non-type
+   parameters in C++17); 250 == 0.25. */
+template <typename Detector, int WeightPermille>
+struct Weighted {
+    using detector = Detector;
+    static constexpr float weight = WeightPermille / 1000.0f;
+};
+
+template <typename... Stages>
+class ScoringPipeline {
+public:
+    static AnomalyScore evaluate(const std::string& client_id, const History& hist) {
+        TimePoint now = engineNow();
+        float total = 0.0f;
+        std::vector<BehaviorPattern> patterns;
+
+        (applyStage<Stages>(hist, now, total, patterns), ...);
+
+        float final_score = std::min(total, 1.0f);
+
+        ThreatLevel level = ThreatLevel::SAFE;
+        if (final_score > 0.9f) level = ThreatLevel::CRITICAL;
+        else if (final_score > 0.75f) level = ThreatLevel::HIGH;
+        else if (final_score > 0.5f) level = ThreatLevel::MEDIUM;
+        else if (final_score > 0.25f) level = ThreatLevel::LOW;
+
+        return { client_id, final_score, level, std::move(patterns), now };
+    }
+
+private:
+    template <typename Stage>
+    static void applyStage(const History& hist, TimePoint now, float& total,
+                           std::vector<BehaviorPattern>& patterns) {
+        float s = Stage::detector::score(hist, now);
+        total += s * Stage::weight;
+        if (s > 0.7f) patterns.push_back(Stage::detector::pattern);
+    }
+};
+
+/* The historical composition: all five detectors at their original
+   weights and windows */
+using DefaultPipeline = ScoringPipeline<
+    Weighted<RapidFailure<>, 250>,
+    Weighted<Enumeration<>, 250>,
+    Weighted<Payload, 300>,
+    Weighted<Timing<>, 100>,
+    Weighted<ResourceAbuse<>, 100>>;
+
+/* Internal-API tier: fixed path space, so no enumeration detector; the
+   freed weight shifts onto injection and abuse */
+using InternalApiPipeline = ScoringPipeline<
+    Weighted<RapidFailure<>, 350>,
+    Weighted<Payload, 400>,
+    Weighted<ResourceAbuse<>, 250>>;
+
+/* Public edge / bot defense: tighter failure window, automation timing
+   and injection dominate */
+using EdgePipeline = ScoringPipeline<
+    Weighted<RapidFailure<30000, 5>, 400>,
+    Weighted<Timing<10>, 300>,
+    Weighted<Payload, 300>>;
+
+} // namespace scoring
+
+#ifndef WC_SCORING_PIPELINE
+#define WC_SCORING_PIPELINE ::WorkChain::Security::scoring::DefaultPipeline
+#endif
+using ActiveScoringPipeline = WC_SCORING_PIPELINE;
+
 class AdaptiveThresholdManager {
 public:
     AdaptiveThresholdManager();
@@ -114,31 +667,158 @@ public:
     
     // FALTABA EN TU CÓDIGO ORIGINAL:
     void resetThresholds();
-    
+
+    /* Snapshot support: hardened thresholds and hit counts ride along in
+       the mesh snapshot so a rolling deploy does not reset them */
+    void snapshotState(std::vector<uint8_t>& out) const;
+    bool restoreState(const uint8_t* data, size_t len);
+
 private:
     std::map<std::string, float> thresholds;
     std::map<std::string, uint32_t> hit_counts;
     mutable std::mutex threshold_mutex;
 };
 
+/* Lock-free token-bucket table used by RateLimitingPolicy's fast path.
+ *
+ * Per-client buckets live in a fixed-capacity open-addressing table of
+ * atomic slots. The bucket itself is one 64-bit word:
+ *   bits [63:24] last refill time (ms since table creation)
+ *   bits [23:0]  available tokens
+ * Refill + consume is a single CAS loop — no mutex, no allocation, so
+ * tryConsume never blocks and scales with core count. Rate updates
+ * (enforceDynamicLimits) go through a plain atomic store on the slot's
+ * rate field; they are rare and may race benignly with consumers.
+ */
+class LockFreeTokenBucketTable {
+public:
+    LockFreeTokenBucketTable(size_t capacity, uint32_t default_rps);
+
+    /* Outcome of a fast-path check. TABLE_FULL means the probe sequence
+       found no free slot; the caller must fall back to the locked path. */
+    enum class Outcome : uint8_t { ALLOWED, LIMITED, TABLE_FULL };
+
+    Outcome tryConsume(const std::string& client_id);
+    void setClientRate(const std::string& client_id, uint32_t rps);
+
+    /* Hash-keyed variant for replicated caps: gossip deltas carry only
+       the client-ID hash, which is exactly the table's key */
+    void setRateForHash(uint64_t client_hash, uint32_t rps);
+
+    /* Generalized forms for the hierarchical limiter: buckets addressed
+       by pre-mixed hash, a weighted cost per check, and an optional
+       fallback rate for buckets whose slot was never explicitly rated
+       (org/resource levels have their own defaults, not the client
+       default). refundHash returns tokens a cascading check charged
+       before a deeper level denied. */
+    Outcome tryConsumeHash(uint64_t key_hash, uint32_t cost, uint32_t fallback_rps = 0);
+    void refundHash(uint64_t key_hash, uint32_t cost, uint32_t fallback_rps = 0);
+
+    void reset();
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> key{0};   // 0 = empty; client-ID hash otherwise
+        std::atomic<uint64_t> state{0}; // packed {last_refill_ms, tokens}; 0 = full bucket
+        std::atomic<uint32_t> rate{0};  // tokens/sec; 0 = use the table default
+    };
+
+    static constexpr uint64_t kTokenBits = 24;
+    static constexpr uint64_t kTokenMask = (1ULL << kTokenBits) - 1;
+    static constexpr size_t kMaxProbes = 16;
+
+    std::unique_ptr<Slot[]> slots;
+    size_t slot_mask;
+    uint32_t default_rps;
+    std::chrono::steady_clock::time_point epoch;
+
+    uint64_t nowMs() const;
+    Slot* findSlot(uint64_t key_hash, bool insert_if_missing);
+};
+
 class RateLimitingPolicy {
 public:
-    RateLimitingPolicy(uint32_t default_rps = 100);
+    RateLimitingPolicy(uint32_t default_rps = 100, size_t shard_count = kDefaultShardCount);
     bool checkLimit(const std::string& client_id);
     void enforceDynamicLimits(const AnomalyScore& anomaly);
-    
+
     // FALTABA EN TU CÓDIGO ORIGINAL:
     void resetPolicies();
-    
+
+    /* When enabled (default), checkLimit runs entirely on the lock-free
+       token-bucket table and only falls back to the sharded mutex path
+       when the table is saturated. */
+    void setLockFreeMode(bool enabled) { lock_free_mode = enabled; }
+
+    /* The cap enforceDynamicLimits would apply for a given level; used
+       to fill gossip deltas so peers apply the same number */
+    uint32_t capForLevel(ThreatLevel level) const;
+
+    /* Applies a cap learned from a peer node. Only the lock-free table
+       is touched — the delta carries a hash, not a client ID, and the
+       table is hash-keyed anyway. */
+    void applyRemoteCap(uint64_t client_hash, uint32_t rps);
+
+    /* * Hierarchical limiting: global → organization → client →
+     * (org, resource) budgets checked in cascade on the lock-free
+     * table. Flat per-client RPS never catches one organization's many
+     * client IDs collectively hammering one expensive endpoint; the org
+     * and org×resource buckets cap exactly that aggregate, and weighted
+     * costs let a report request consume more budget than a ping.
+     *
+     * All four levels live in the same hash-slot table under
+     * domain-tagged keys, so a scoped check is at most four CAS loops
+     * and no locks. Levels charged before a deeper level denies are
+     * refunded, keeping the cascade conservative. An empty org_id skips
+     * the org and org×resource levels. cost_override 0 means "use the
+     * configured resource cost" (default 1). */
+    void configureHierarchy(uint32_t global_rps, uint32_t org_rps_default,
+                            uint32_t resource_rps_default);
+    void setOrgRate(const std::string& org_id, uint32_t rps);
+    void setResourceCost(const std::string& resource_id, uint32_t cost);
+    bool checkLimitScoped(const std::string& org_id, const std::string& client_id,
+                          const std::string& resource_id, uint32_t cost_override = 0);
+    bool hierarchyEnabled() const { return hierarchy_enabled.load(std::memory_order_relaxed); }
+
 private:
     struct ClientPolicy {
         uint32_t requests_per_second;
         TimePoint last_reset;
         uint32_t request_count;
     };
-    std::unordered_map<std::string, ClientPolicy> policies;
+
+    /* Same sharding scheme as BehaviorAnalyzer so one client hits the
+       same relative shard in both subsystems (cache-friendly) */
+    struct PolicyShard {
+        std::unordered_map<std::string, ClientPolicy> policies;
+        std::mutex mutex;
+    };
+
+    std::vector<std::unique_ptr<PolicyShard>> shards;
+    size_t shard_mask;
     uint32_t default_rps;
-    std::mutex policy_mutex;
+
+    LockFreeTokenBucketTable bucket_table;
+    std::atomic<bool> lock_free_mode{true};
+
+    /* Hierarchy state. Budgets and costs change rarely (operator
+       actions); reads take a shared lock only on the cost lookup. */
+    std::atomic<bool> hierarchy_enabled{false};
+    uint32_t global_rps = 0;
+    uint32_t org_rps_default = 0;
+    uint32_t resource_rps_default = 0;
+    std::unordered_map<std::string, uint32_t> resource_costs;
+    mutable std::shared_mutex hierarchy_mutex;
+
+    /* Domain-tagged bucket keys: the four levels share the slot table
+       without colliding */
+    static uint64_t scopedKey(uint64_t domain_tag, uint64_t h);
+
+    bool checkLimitLocked(const std::string& client_id); // mutex fallback path
+
+    PolicyShard& shardFor(const std::string& client_id) {
+        return *shards[clientShardIndex(client_id, shard_mask)];
+    }
 };
 
 class ThreatResponseEngine {
@@ -152,28 +832,445 @@ public:
     void rerouteTraffic(const std::string& client_id);
     
     void generateAlert(const AnomalyScore& anomaly);
-    
+
+    /* O(1) isolation check — the first gate in processRequest, so
+       blocking a condemned client costs one hash lookup instead of a
+       full history re-analysis. Expired entries are auto-released on
+       the way (timed isolation, not a life sentence). */
+    bool isIsolated(const std::string& client_id);
+
+    /* Manual release (operator override) */
+    void releaseClient(const std::string& client_id);
+
+    size_t isolatedCount();
+
+    /* Snapshot support: isolation ages are serialized relative to `now`
+       (monotonic clocks do not survive restarts) */
+    void snapshotIsolation(std::vector<uint8_t>& out, TimePoint now);
+    bool restoreIsolation(const uint8_t* data, size_t len, TimePoint now);
+
 private:
+    /* Auto-release horizons by severity */
+    static constexpr std::chrono::minutes kCriticalIsolation{15};
+    static constexpr std::chrono::minutes kDefaultIsolation{5};
+
     struct ClientIsolation {
-        std::string client_id;
         ThreatLevel level;
         TimePoint isolation_start;
+        TimePoint release_at;     // timed auto-release
         std::string reason;
     };
-    std::vector<ClientIsolation> isolated_clients;
+    /* Hash-indexed by client ID; isIsolated is a single find() */
+    std::unordered_map<std::string, ClientIsolation> isolated_clients;
     std::mutex response_mutex;
 };
 
+/* Bounded lock-free queue (Vyukov-style ring with per-cell sequence
+ * numbers). Producers are the request threads handing off recordBehavior
+ * work; the consumer is the mesh's analyzer thread. tryPush never blocks
+ * — when the ring is full the caller falls back to synchronous
+ * processing rather than waiting.
+ */
+template <typename T>
+class BoundedMpscQueue {
+public:
+    explicit BoundedMpscQueue(size_t capacity) {
+        size_t count = roundUpToPowerOfTwo(std::max<size_t>(4, capacity));
+        ring_mask = count - 1;
+        cells = std::make_unique<Cell[]>(count);
+        for (size_t i = 0; i < count; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool tryPush(T&& value) {
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & ring_mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T& out) {
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        Cell& cell = cells[pos & ring_mask];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(pos + 1) < 0) return false; // empty
+        dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+        out = std::move(cell.value);
+        cell.sequence.store(pos + ring_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+    std::unique_ptr<Cell[]> cells;
+    size_t ring_mask;
+    std::atomic<size_t> enqueue_pos{0};
+    std::atomic<size_t> dequeue_pos{0};
+};
+
+/* Memory-mapped decision cache shared between the mesh and sibling
+ * gateway processes (Caddy edge helper, Go crypto-service) on the same
+ * box. The mesh publishes {score, level, expiry} per client into a
+ * fixed-size slot table in a POSIX shared-memory segment; readers map it
+ * once and read with zero syscalls and zero IPC. Each slot is a seqlock:
+ * the writer bumps the sequence to odd, writes, bumps to even; a reader
+ * retries if it saw an odd or changed sequence (torn-read detection).
+ * Slots are direct-mapped by client-ID hash — a collision just evicts,
+ * which is safe because a missing or stale slot forces re-analysis.
+ */
+class SharedDecisionCache {
+public:
+    SharedDecisionCache() = default;
+    ~SharedDecisionCache();
+
+    /* Writer side: creates (or re-creates) the segment. slot_count is
+       rounded up to a power of two. */
+    bool create(const std::string& name, size_t slot_count);
+
+    /* Reader side: maps an existing segment */
+    bool open(const std::string& name);
+
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    /* Publishes a verdict valid for ttl_ms from now */
+    void publish(const std::string& client_id, float score, ThreatLevel level, uint64_t ttl_ms);
+
+    /* Returns false if the slot is missing, expired, or belongs to a
+       different client (hash collision) — the caller must re-analyze */
+    bool read(const std::string& client_id, float* score, ThreatLevel* level) const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence; // odd while a write is in flight
+        uint64_t client_hash;
+        uint64_t expiry_ms;             // CLOCK_REALTIME ms, cross-process comparable
+        float score;
+        uint8_t level;
+    };
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t slot_count;
+    };
+
+    static constexpr uint32_t kMagic = 0x57435344; // "WCSD"
+    static constexpr uint32_t kVersion = 1;
+
+    static uint64_t wallClockMs();
+
+    Header* header = nullptr;
+    Slot* slots = nullptr;
+    size_t slot_mask = 0;
+    size_t mapped_size = 0;
+    std::string shm_name;
+    bool owner = false;
+};
+
+/* UDP gossip of threat-state deltas between gateway mesh instances.
+ *
+ * Each node runs one replicator bound to a local port with the other
+ * gateways as peers. Verdicts are submitted as compact deltas
+ * {client-ID hash, score, level, flags, rate cap}; the sender coalesces
+ * them per client (latest wins) and flushes batches every
+ * kFlushIntervalMs, so a hammered client costs one wire record per
+ * flush, not one per request. The receiver hands each delta to an apply
+ * callback. Delivery is best-effort and eventually consistent — a lost
+ * datagram means a peer converges one flush later, which is acceptable;
+ * the point is that an attacker rotating across N gateways no longer
+ * gets N independent rate budgets.
+ */
+class GossipReplicator {
+public:
+    struct Delta {
+        uint64_t client_hash;
+        float score;
+        uint32_t rate_cap;   // 0 = no cap change
+        uint8_t level;       // ThreatLevel
+        uint8_t flags;
+    };
+    static constexpr uint8_t kFlagIsolated = 1u << 0;
+
+    using ApplyFn = std::function<void(const Delta&)>;
+
+    GossipReplicator() = default;
+    ~GossipReplicator();
+
+    /* peers are "a.b.c.d:port" addresses of the other gateway nodes */
+    bool start(uint16_t listen_port, const std::vector<std::string>& peers, ApplyFn apply);
+    void stop();
+    bool isRunning() const { return sock_fd >= 0; }
+
+    /* Queues a delta for the next flush, coalescing by client hash */
+    void submit(const Delta& delta);
+
+private:
+    static constexpr uint32_t kWireMagic = 0x57435447; // "WCTG"
+    static constexpr uint8_t kWireVersion = 1;
+    static constexpr size_t kMaxDeltasPerDatagram = 64;
+    static constexpr std::chrono::milliseconds kFlushInterval{50};
+
+    void senderLoop();
+    void receiverLoop();
+
+    /* Parsed peer endpoints, network byte order (kept POD so the socket
+       headers stay out of this header) */
+    struct PeerAddr {
+        uint32_t ip_be;
+        uint16_t port_be;
+    };
+
+    int sock_fd = -1;
+    std::vector<PeerAddr> peer_addrs;
+    ApplyFn apply_fn;
+
+    std::unordered_map<uint64_t, Delta> pending; // coalescing buffer
+    std::mutex pending_mutex;
+    std::condition_variable pending_cv;
+
+    std::thread sender_thread;
+    std::thread receiver_thread;
+    std::atomic<bool> stop_flag{false};
+};
+
+/* Telemetry hub: hot-path instrumentation without touching a stream.
+ *
+ * The response engine used to write alerts with std::cout << std::endl —
+ * a flush per event on a mutex-protected stream, in the middle of threat
+ * response. Emitting is now a write into the calling thread's private
+ * event ring (no lock, no syscall, no allocation — tens of nanoseconds);
+ * a background exporter drains every ring on a short period and hands
+ * batches to pluggable sinks (binary file, UDP to the SIEM). Counters
+ * and a log-scale latency histogram cover checkLimit outcomes and
+ * analyzeBehavior cost, and renderPrometheus() formats them for a
+ * scrape endpoint. When the ring is full the event is dropped and
+ * counted — the hot path never waits for the exporter.
+ */
+/* Probabilistic admission pre-filter: the cheap tier ahead of full
+ * behavior analysis. Over 95% of traffic is well-behaved ERP users, yet
+ * every request paid recordBehavior plus analyzeBehavior. The filter
+ * keeps two fixed-size sketches — a count-min of per-client request
+ * rate over a decaying window, and a Bloom filter of (client, resource)
+ * pairs already seen — and fast-ALLOWs clients whose rate estimate sits
+ * well below every detector threshold and who are touching resources
+ * they have touched before (no enumeration signal). Count-min
+ * overestimates and Bloom false-positives both err toward the full
+ * path, never toward a wrong fast ALLOW beyond the configured rate.
+ *
+ * Slow-burn attackers are caught by sampled promotion: one in
+ * kSampleShift-th of fast-path-eligible requests is forced through the
+ * analyzer anyway, so per-client history still accumulates and periodic
+ * full analysis sees long-running low-rate campaigns.
+ */
+class AdmissionPrefilter {
+public:
+    AdmissionPrefilter();
+
+    /* Records the observation into the sketches and returns true if the
+       request can be admitted without full analysis */
+    bool admitFast(uint64_t client_hash, uint64_t resource_hash);
+
+private:
+    static constexpr size_t kRows = 4;          // count-min depth
+    static constexpr size_t kColsLog2 = 14;     // 16384 counters per row
+    static constexpr size_t kBloomWords = 1 << 16; // 4 Mbit pair filter
+    static constexpr uint32_t kBoringRate = 16; // window estimate considered quiet
+    static constexpr uint64_t kWindowMs = 60000;
+    static constexpr uint64_t kSampleMask = 63; // promote 1 in 64
+
+    void maybeDecay(uint64_t now_ms); // halves the counters once per window
+
+    std::unique_ptr<std::atomic<uint32_t>[]> counters; // kRows rows, flattened
+    std::unique_ptr<std::atomic<uint64_t>[]> bloom;
+    std::atomic<uint64_t> window_start_ms{0};
+    std::atomic<uint64_t> sample_counter{0};
+    std::mutex decay_mutex;
+    std::chrono::steady_clock::time_point epoch;
+};
+
+class TelemetryHub {
+public:
+    enum class EventType : uint8_t {
+        CLIENT_ISOLATED = 0,
+        CLIENT_THROTTLED = 1,
+        ANOMALY_ALERT = 2,
+        TRAFFIC_REROUTED = 3
+    };
+
+    /* Fixed-width binary event record (what the sinks receive) */
+    struct Event {
+        uint64_t timestamp_ms;   // wall clock, cross-process comparable
+        uint64_t client_hash;
+        float score;
+        uint8_t level;           // ThreatLevel
+        uint8_t type;            // EventType
+    };
+
+    class Sink {
+    public:
+        virtual ~Sink() = default;
+        virtual void consume(const Event* events, size_t count) = 0;
+    };
+
+    static TelemetryHub& instance();
+
+    /* Hot-path emit: one ring write on the calling thread */
+    void emit(EventType type, uint64_t client_hash, float score, ThreatLevel level);
+
+    /* Counters / histogram, all single atomic increments */
+    void countCheckLimit(bool allowed);
+    void recordAnalyzeLatency(uint64_t nanos);
+
+    void addSink(std::shared_ptr<Sink> sink);
+    void start();   // spawns the exporter; idempotent
+    void stop();
+
+    /* Prometheus text exposition of the counters and histogram */
+    std::string renderPrometheus() const;
+
+private:
+    static constexpr size_t kRingSize = 4096;        // power of two
+    static constexpr size_t kLatencyBuckets = 16;    // log2(us) buckets
+
+    /* SPSC ring: the owning thread writes, the exporter reads */
+    struct ThreadRing {
+        std::array<Event, kRingSize> events;
+        std::atomic<uint64_t> head{0};   // producer
+        std::atomic<uint64_t> tail{0};   // exporter
+        std::atomic<bool> retired{false};
+    };
+
+    TelemetryHub() = default;
+    ~TelemetryHub();
+
+    ThreadRing* threadRing(); // registers the calling thread's ring lazily
+    void exporterLoop();
+    void drainRings(std::vector<Event>& scratch);
+
+    std::vector<std::unique_ptr<ThreadRing>> rings; // grows, never shrinks
+    std::mutex ring_registry_mutex;
+
+    std::vector<std::shared_ptr<Sink>> sinks;
+    std::mutex sink_mutex;
+
+    std::thread exporter_thread;
+    std::atomic<bool> exporter_stop{false};
+    std::atomic<bool> exporter_running{false};
+
+    std::atomic<uint64_t> dropped_events{0};
+    std::atomic<uint64_t> checklimit_allowed{0};
+    std::atomic<uint64_t> checklimit_blocked{0};
+    std::array<std::atomic<uint64_t>, kLatencyBuckets> analyze_latency_us{};
+};
+
+/* Appends binary Event records to a local file */
+class FileTelemetrySink : public TelemetryHub::Sink {
+public:
+    explicit FileTelemetrySink(const std::string& path);
+    ~FileTelemetrySink() override;
+    void consume(const TelemetryHub::Event* events, size_t count) override;
+    bool isOpen() const { return fd >= 0; }
+
+private:
+    int fd = -1;
+};
+
+/* Ships event batches as UDP datagrams to the SIEM collector */
+class UdpTelemetrySink : public TelemetryHub::Sink {
+public:
+    UdpTelemetrySink(const std::string& host, uint16_t port);
+    ~UdpTelemetrySink() override;
+    void consume(const TelemetryHub::Event* events, size_t count) override;
+    bool isOpen() const { return fd >= 0; }
+
+private:
+    static constexpr size_t kEventsPerDatagram = 32;
+    int fd = -1;
+    uint32_t dest_ip_be = 0;
+    uint16_t dest_port_be = 0;
+};
+
 class NanoSecurityMesh {
 public:
     NanoSecurityMesh();
     ~NanoSecurityMesh();
-    
-    void initialize();
-    
+
+    /* shard_count: number of independent client-state shards (rounded up to
+       a power of two). Defaults to kDefaultShardCount; see the scaling notes
+       above it. Re-initializing rebuilds analyzer and limiter state. */
+    void initialize(size_t shard_count = kDefaultShardCount,
+                    const std::string& snapshot_path = {});
+
     // CRITICO: Devuelve bool para permitir bloquear el login
     bool processRequest(const std::string& client_id, const BehaviorMetrics& metrics);
-    
+
+    /* Zero-copy admission path: IDs are consumed as views straight from
+       the caller's request buffer and interned at most once. The legacy
+       overload above flattens its BehaviorMetrics into this path. */
+    bool processRequest(std::string_view client_id, const BehaviorSample& sample);
+
+    /* Batch admission: one engine crossing for a whole batch of requests
+       instead of one FFI/IPC round trip each. decisions[i] receives the
+       ALLOW/BLOCK verdict for requests[i]. */
+    void processBatch(const BehaviorMetrics* requests, size_t count, bool* decisions);
+
+    /* Async analysis mode: processRequest answers immediately from the
+       rate limiter plus the last known AnomalyScore, and hands the
+       recordBehavior/analyzeBehavior work to a dedicated analyzer thread
+       via a bounded MPSC queue. Admission latency drops to the fast-path
+       cost; scores lag by at most the queue drain time (well under the
+       10ms staleness our callers tolerate). When the queue is full the
+       request falls back to the synchronous path. */
+    void setAsyncAnalysis(bool enabled);
+
+    /* Publishes every verdict into a named shared-memory segment that
+       sibling processes can read without IPC, and serves getThreatLevel /
+       getAnomalyScore from it while fresher than staleness_ms. */
+    bool enableSharedDecisionCache(const std::string& shm_name,
+                                   size_t slot_count = 1 << 16,
+                                   uint64_t staleness_ms = 50);
+
+    /* Enables the probabilistic admission tier: statistically quiet
+       clients on already-seen resources are ALLOWed from two sketch
+       probes, skipping recordBehavior/analyzeBehavior entirely (with
+       sampled promotion so slow-burn attackers still surface). */
+    void setPreFilter(bool enabled) { prefilter_enabled = enabled; }
+
+    /* Joins the gateway gossip cluster: local verdicts at MEDIUM and
+       above are replicated to peers, and peer deltas tighten this node's
+       rate caps and isolation set. See GossipReplicator. */
+    bool enableGossip(uint16_t listen_port, const std::vector<std::string>& peers);
+
+    /* State persistence across restarts. Without it every deploy starts
+       with empty histories and default thresholds, handing attackers a
+       fresh learning window. saveSnapshot writes a versioned sectioned
+       binary file (atomically, via rename); loadSnapshot maps it
+       read-only and bulk-restores analyzer histories, adaptive
+       thresholds and isolation state, then rebuilds the derived
+       aggregates — restoring millions of records is bounded by the ring
+       fills, not by re-learning. enableSnapshots additionally writes the
+       file on a timer and at shutdown. */
+    bool saveSnapshot(const std::string& path);
+    bool loadSnapshot(const std::string& path);
+    void enableSnapshots(const std::string& path, std::chrono::seconds interval);
+
     ThreatLevel getThreatLevel(const std::string& client_id);
     
     // FALTABAN EN TU CÓDIGO ORIGINAL:
@@ -186,7 +1283,65 @@ private:
     std::unique_ptr<AdaptiveThresholdManager> threshold_manager;
     std::unique_ptr<RateLimitingPolicy> rate_limiter;
     std::unique_ptr<ThreatResponseEngine> response_engine;
-    
+
+    /* Last published verdict per client, consulted by the async fast path */
+    struct CachedDecision {
+        float score = 0.0f;
+        ThreatLevel level = ThreatLevel::SAFE;
+        bool payload_injection = false;
+        TimePoint updated{};
+    };
+    struct DecisionCacheShard {
+        std::unordered_map<std::string, CachedDecision> decisions;
+        mutable std::shared_mutex mutex;
+    };
+    static constexpr size_t kDecisionCacheShards = 64; // power of two
+
+    std::array<DecisionCacheShard, kDecisionCacheShards> decision_cache;
+
+    void publishDecision(const AnomalyScore& anomaly);
+    bool lookupDecision(const std::string& client_id, CachedDecision& out) const;
+
+    SharedDecisionCache shared_cache;
+    std::atomic<uint64_t> shared_cache_ttl_ms{50};
+
+    /* Cluster replication: clients isolated by a peer node are tracked
+       by hash (the wire format carries no IDs) and blocked up front */
+    void applyRemoteDelta(const GossipReplicator::Delta& delta);
+    bool isRemotelyIsolated(const std::string& client_id) const;
+
+    AdmissionPrefilter prefilter;
+    std::atomic<bool> prefilter_enabled{false};
+
+    GossipReplicator gossip;
+    std::atomic<bool> gossip_enabled{false};
+    std::unordered_set<uint64_t> remote_isolated;
+    mutable std::shared_mutex remote_isolated_mutex;
+
+    /* Full synchronous record+analyze+respond pipeline */
+    bool processRequestSync(const std::string& client_id, const BehaviorSample& sample);
+
+    /* Rate gate shared by both admission paths: hierarchical cascade
+       when configured (org scope comes from the "<org>:<client>" ID
+       convention; IDs without a prefix skip the org levels), flat
+       per-client check otherwise */
+    bool admitRate(const std::string& client_id, std::string_view resource_id);
+    void analyzerLoop();
+
+    BoundedMpscQueue<BehaviorRecord> analysis_queue{8192};
+    std::thread analyzer_thread;
+    std::atomic<bool> async_enabled{false};
+    std::atomic<bool> analyzer_stop{false};
+
+    void snapshotLoop();
+
+    std::thread snapshot_thread;
+    std::mutex snapshot_mutex;               // guards path/interval + wakeup
+    std::condition_variable snapshot_cv;
+    std::atomic<bool> snapshot_stop{false};
+    std::string snapshot_path;
+    std::chrono::seconds snapshot_interval{0};
+
     std::atomic<bool> initialized;
     std::mutex mesh_mutex;
 };